@@ -0,0 +1,42 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPCOSTESTIMATE_H
+#define INCLUDED_LIBQXP_QXPCOSTESTIMATE_H
+
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Estimated cost of parsing a document, together with the signals
+  * it is based on.
+  *
+  * The estimate is rough: it is meant for ordering and packing of
+  * jobs, not for exact predictions.
+  */
+class QXPAPI QXPCostEstimate
+{
+public:
+  QXPCostEstimate();
+
+  unsigned blockCount; //< number of 256-byte blocks of the file
+  unsigned long documentChainLength; //< length of the main document chain in bytes
+  unsigned pageCount; //< number of pages, including master pages
+  unsigned long contentLength; //< bytes of the file outside the document chain, mostly stories and pictures
+
+  double cpuTime; //< estimated CPU time of a full parse in seconds
+  unsigned long peakMemory; //< estimated peak memory of a full parse in bytes
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPCOSTESTIMATE_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -13,7 +13,12 @@
 #include <librevenge/librevenge.h>
 #include <librevenge-stream/librevenge-stream.h>
 
+#include "QXPCostEstimate.h"
+#include "QXPInventory.h"
+#include "QXPMemoryStats.h"
+#include "QXPParseOptions.h"
 #include "QXPPathResolver.h"
+#include "QXPTextSink.h"
 #include "libqxp_api.h"
 
 namespace libqxp
@@ -30,7 +35,9 @@ public:
     RESULT_FILE_ACCESS_ERROR, //< problem when accessing the file
     RESULT_PARSE_ERROR, //< problem when parsing the file
     RESULT_UNSUPPORTED_FORMAT, //< unsupported file format
-    RESULT_UNKNOWN_ERROR //< an unspecified error
+    RESULT_UNKNOWN_ERROR, //< an unspecified error
+    RESULT_CANCELLED, //< the parse was cancelled through QXPParseOptions
+    RESULT_DEADLINE_EXCEEDED //< the parse ran past the deadline set in QXPParseOptions
   };
 
   /** Type of document.
@@ -45,8 +52,99 @@ public:
     TYPE_LIBRARY
   };
 
+  /** Container the document was found in.
+    */
+  enum Wrapper
+  {
+    WRAPPER_NONE, //< plain document
+    WRAPPER_BINHEX, //< BinHex 4.0 encoded Mac file
+    WRAPPER_MACMIME, //< AppleSingle or AppleDouble file
+    WRAPPER_ZIP, //< zip archive, possibly with the resource fork in __MACOSX/
+    WRAPPER_FORKS //< structured stream with the forks as substreams
+  };
+
+  /** Basic facts about a document, as found in its header.
+    */
+  struct Info
+  {
+    Info()
+      : version(0), bigEndian(false), type(TYPE_UNKNOWN), pageCount(0), masterPageCount(0), encoding(0), wrapper(WRAPPER_NONE)
+    { }
+
+    unsigned version; //< file format version, as stored in the header
+    bool bigEndian; //< the document was created on Mac
+    Type type; //< type of the document
+    unsigned pageCount; //< number of pages, master pages are not counted
+    unsigned masterPageCount; //< number of master pages
+    const char *encoding; //< name of the encoding of text, in ICU format
+    Wrapper wrapper; //< container the document was unwrapped from
+  };
+
   static QXPAPI bool isSupported(librevenge::RVNGInputStream *input, Type *type = 0);
+
+  /** Reads basic facts about the document from its header.
+    *
+    * Only the header is read, so this is about as cheap as
+    * isSupported.
+    *
+    * @param[out] info the facts
+    */
+  static QXPAPI Result getInfo(librevenge::RVNGInputStream *input, Info &info);
+  /** Parses the document.
+    *
+    * Everything is parsed on the calling thread. To use more threads,
+    * set their count in QXPParseOptions; pages are still passed to
+    * @c document in order, from the calling thread.
+    *
+    * Books and libraries are recognized by isSupported, but they are not
+    * parsed: @c RESULT_UNSUPPORTED_FORMAT is returned for them.
+    */
   static QXPAPI Result parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *document, QXPPathResolver *resolver = 0);
+
+  /** Parses the document and records memory usage of the import.
+    *
+    * @param[out] stats memory statistics; counters are added to the
+    *   current values, so the same object can be used for several
+    *   documents
+    */
+  static QXPAPI Result parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *document, QXPPathResolver *resolver, QXPMemoryStats *stats);
+
+  /** Parses the document within limits and reports its progress.
+    *
+    * @param[in] stats memory statistics, may be null
+    * @param[in] options deadline, cancellation and threads of the parse
+    *   and receiver of its progress, may be null
+    */
+  static QXPAPI Result parse(librevenge::RVNGInputStream *input, librevenge::RVNGDrawingInterface *document, QXPPathResolver *resolver, QXPMemoryStats *stats, QXPParseOptions *options);
+
+  /** Extracts text of all stories of the document.
+    *
+    * This is much cheaper than a full parse, as no drawing is done
+    * and pictures are not read.
+    *
+    * @param[in] sink receives text of the stories, in reading order
+    */
+  static QXPAPI Result extractText(librevenge::RVNGInputStream *input, QXPTextSink *sink, QXPPathResolver *resolver = 0);
+
+  /** Gathers a summary of the document's content.
+    *
+    * Nothing is drawn, text is not decoded and picture data are not
+    * read.
+    *
+    * @param[out] inventory the summary
+    */
+  static QXPAPI Result getInventory(librevenge::RVNGInputStream *input, QXPInventory &inventory);
+
+  /** Estimates CPU time and peak memory needed to parse the document.
+    *
+    * The estimate is based on page counts from the header and on the
+    * sizes of the file and of its document chain. Only the header and
+    * the links between blocks of the document chain are read.
+    *
+    * @param[out] estimate the estimate and the signals it is based on
+    */
+  static QXPAPI Result estimateCost(librevenge::RVNGInputStream *input, QXPCostEstimate &estimate);
+
 };
 
 } // namespace libqxp
@@ -0,0 +1,76 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPDOCUMENTREADER_H
+#define INCLUDED_LIBQXP_QXPDOCUMENTREADER_H
+
+#include <memory>
+
+#include <librevenge/librevenge.h>
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "QXPDocument.h"
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Reads a document one page at a time.
+  *
+  * Unlike QXPDocument::parse, which converts the whole document at
+  * once, the reader parses only as far as needed to produce the next
+  * page and keeps its state between the calls. So the first page is
+  * available as soon as it is parsed, whatever the length of the
+  * document, and the rest is not parsed at all if the reader is
+  * destroyed early. The pages are read from the input as they are
+  * parsed, so only the part of the document being parsed is held in
+  * memory.
+  *
+  * Only documents and templates can be read this way.
+  */
+class QXPAPI QXPDocumentReader
+{
+  // disable copying
+  QXPDocumentReader(const QXPDocumentReader &other) = delete;
+  QXPDocumentReader &operator=(const QXPDocumentReader &other) = delete;
+
+public:
+  QXPDocumentReader();
+  ~QXPDocumentReader();
+
+  /** Starts reading @c input, parsing everything that precedes the pages.
+    *
+    * The input must stay valid until the reader is destroyed or another
+    * input is opened.
+    */
+  QXPDocument::Result open(librevenge::RVNGInputStream *input);
+
+  /** Draws the next page to @c painter.
+    *
+    * The page is passed as a document of its own, so every page can go
+    * to a different painter. Pages with text continued from later pages
+    * are only drawn once the text is parsed. If there are no more pages,
+    * nothing is drawn.
+    */
+  QXPDocument::Result nextPage(librevenge::RVNGDrawingInterface *painter);
+
+  /** Returns true if all pages have been drawn, or reading failed.
+    */
+  bool isDone() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPDOCUMENTREADER_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,75 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPFILESTREAM_H
+#define INCLUDED_LIBQXP_QXPFILESTREAM_H
+
+#include <memory>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Input stream of a file that can be told what is going to be read.
+  *
+  * Block chains of a document are scattered over the file. If the
+  * input is a QXPFileStream, the parser tells the system which blocks
+  * of stories and pictures it is going to read, so they are already
+  * being read while pages are parsed. The hints do not block and do
+  * not move the position of the stream.
+  *
+  * Archives and other structured files are opened through
+  * librevenge::RVNGFileStream, so they can be read as well.
+  */
+class QXPAPI QXPFileStream : public librevenge::RVNGInputStream
+{
+  // disable copying
+  QXPFileStream(const QXPFileStream &other) = delete;
+  QXPFileStream &operator=(const QXPFileStream &other) = delete;
+
+public:
+  /** Opens @c filename for reading.
+    *
+    * If the file cannot be opened, the stream is empty.
+    */
+  explicit QXPFileStream(const char *filename);
+  ~QXPFileStream() override;
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+  /** Tells the system that @c length bytes from @c offset will be read soon.
+    *
+    * This is just a hint: it does nothing where the system does not
+    * support it. It may be called from any thread.
+    */
+  virtual void willNeed(unsigned long offset, unsigned long length) const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPFILESTREAM_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,46 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPINVENTORY_H
+#define INCLUDED_LIBQXP_QXPINVENTORY_H
+
+#include <librevenge/librevenge.h>
+
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Summary of the content of a document.
+  *
+  * It is gathered without drawing the document, decoding text or
+  * reading picture data.
+  */
+class QXPAPI QXPInventory
+{
+public:
+  QXPInventory();
+
+  unsigned version; //< file format version, as stored in the header
+  unsigned pageCount; //< number of pages, master pages are not counted
+  double pageWidth; //< width of the first page in points
+  double pageHeight; //< height of the first page in points
+  librevenge::RVNGStringVector fonts; //< fonts used by the text of stories
+  librevenge::RVNGStringVector colors; //< colors defined in the document, as #rrggbb
+  unsigned pictureCount; //< number of pictures
+  unsigned long pictureBytes; //< total size of picture data, as stored in the document
+  unsigned storyCount; //< number of stories
+  unsigned long characterCount; //< total length of all stories
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPINVENTORY_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
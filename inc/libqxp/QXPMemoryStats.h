@@ -0,0 +1,99 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPMEMORYSTATS_H
+#define INCLUDED_LIBQXP_QXPMEMORYSTATS_H
+
+#include <memory>
+
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Memory usage of the import, split by the data it is spent on.
+  *
+  * All sizes are in bytes. Only the big buffers held by the import
+  * are accounted for, not every single allocation. Allocations and
+  * releases may be recorded from several threads.
+  */
+class QXPAPI QXPMemoryStats
+{
+  // disable copying
+  QXPMemoryStats(const QXPMemoryStats &other) = delete;
+  QXPMemoryStats &operator=(const QXPMemoryStats &other) = delete;
+
+public:
+  /** Accounted category.
+    */
+  enum Category
+  {
+    CATEGORY_PICTURES, ///< picture data waiting to be drawn
+    CATEGORY_TEXTS, ///< parsed stories
+    CATEGORY_PAGES, ///< objects of pages that have not been drawn yet
+    CATEGORY_STREAMS, ///< in-memory copies of block chains
+    /** Output produced by the generator.
+      *
+      * The library never records it, as it does not see the output.
+      * A caller that keeps the output in memory can record it; if that
+      * is done once the parse has returned, as the converters do, the
+      * peak is just the size of the output and is not part of the peak
+      * of the total during the parse.
+      */
+    CATEGORY_OUTPUT,
+    CATEGORY_COUNT
+  };
+
+  /** Current and peak usage.
+    */
+  struct Usage
+  {
+    unsigned long current;
+    unsigned long peak;
+  };
+
+  QXPMemoryStats();
+  ~QXPMemoryStats();
+
+  /** Resets all counters to zero.
+    */
+  void clear();
+
+  /** Records allocation of @c size bytes in @c category.
+    */
+  void allocate(Category category, unsigned long size);
+
+  /** Records release of @c size bytes in @c category.
+    */
+  void release(Category category, unsigned long size);
+
+  /** Returns usage of a single category.
+    */
+  Usage usage(Category category) const;
+
+  /** Returns usage summed over all categories.
+    *
+    * The peak is the peak of the sum, not the sum of peaks.
+    */
+  Usage total() const;
+
+  /** Returns a short human-readable name of @c category.
+    */
+  static const char *categoryName(Category category);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPMEMORYSTATS_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,95 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPPARSEOPTIONS_H
+#define INCLUDED_LIBQXP_QXPPARSEOPTIONS_H
+
+#include <atomic>
+#include <chrono>
+
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Limits of a parse and a hook to follow its progress.
+  *
+  * The limits are checked at page and object boundaries and while
+  * block chains are read, so a parse stops soon after it runs past
+  * the deadline or is cancelled, whatever the document contains. The
+  * output is incomplete then: pages held back for text continued on
+  * later pages are dropped and the document is not ended.
+  */
+class QXPAPI QXPParseOptions
+{
+  // disable copying
+  QXPParseOptions(const QXPParseOptions &other) = delete;
+  QXPParseOptions &operator=(const QXPParseOptions &other) = delete;
+
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  QXPParseOptions();
+  virtual ~QXPParseOptions();
+
+  /** Sets the time by which the parse has to end.
+    *
+    * There is no deadline by default.
+    */
+  void setDeadline(Clock::time_point deadline);
+
+  /** Returns true if the deadline is set and has passed.
+    */
+  bool isPastDeadline() const;
+
+  /** Asks the parse to stop.
+    *
+    * This can be called from any thread, also before the parse starts.
+    */
+  void cancel();
+
+  /** Returns true if cancel has been called.
+    */
+  bool isCancelled() const;
+
+  /** Sets how many threads the parse may use.
+    *
+    * With more than 1, pages of big documents are parsed concurrently
+    * and stories and pictures are decoded in the background; 0 picks
+    * the count by the size of the document and the number of CPUs.
+    * The default is 1: everything is parsed on the calling thread.
+    */
+  void setMaxThreads(unsigned maxThreads);
+
+  /** Returns how many threads the parse may use.
+    */
+  unsigned maxThreads() const;
+
+  /** Called after every page of the document has been parsed or skipped.
+    *
+    * It is called from the thread the parse was started on, master
+    * pages are not counted.
+    *
+    * @param[in] done number of pages done so far
+    * @param[in] total number of pages of the document
+    */
+  virtual void progress(unsigned done, unsigned total);
+
+private:
+  std::atomic<bool> m_cancelled;
+  bool m_hasDeadline;
+  Clock::time_point m_deadline;
+  unsigned m_maxThreads;
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPPARSEOPTIONS_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,41 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef INCLUDED_LIBQXP_QXPTEXTSINK_H
+#define INCLUDED_LIBQXP_QXPTEXTSINK_H
+
+#include "libqxp_api.h"
+
+namespace libqxp
+{
+
+/** Receives text extracted from a document.
+  */
+class QXPAPI QXPTextSink
+{
+public:
+  virtual ~QXPTextSink() = default;
+
+  /** Receives the text of one story.
+    *
+    * Stories are sent in reading order, each of them exactly once,
+    * no matter how many linked boxes it flows through. Paragraphs
+    * and line breaks are terminated by '\n'.
+    *
+    * @param[in] text UTF-8 text, not zero-terminated
+    * @param[in] length length of the text in bytes
+    */
+  virtual void insertStory(const char *text, unsigned long length) = 0;
+};
+
+} // namespace libqxp
+
+#endif // INCLUDED_LIBQXP_QXPTEXTSINK_H
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,8 +10,15 @@
 #ifndef INCLUDED_LIBQXP_LIBQXP_H
 #define INCLUDED_LIBQXP_LIBQXP_H
 
+#include "QXPCostEstimate.h"
 #include "QXPDocument.h"
+#include "QXPDocumentReader.h"
+#include "QXPFileStream.h"
+#include "QXPInventory.h"
+#include "QXPMemoryStats.h"
+#include "QXPParseOptions.h"
 #include "QXPPathResolver.h"
+#include "QXPTextSink.h"
 
 #endif // INCLUDED_LIBQXP_LIBQXP_H
 
@@ -0,0 +1,150 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/libqxp.h>
+
+namespace
+{
+
+int printUsage()
+{
+  std::printf("`qxpdetectbench' measures detection of QuarkXPress documents.\n");
+  std::printf("\n");
+  std::printf("Usage: qxpdetectbench [OPTION] FILE...\n");
+  std::printf("\n");
+  std::printf("The files are read into memory first, so only detection itself is\n");
+  std::printf("measured. Pass a mix of documents, containers and unrelated files\n");
+  std::printf("to get numbers representative of a real intake.\n");
+  std::printf("\n");
+  std::printf("Options:\n");
+  std::printf("\t--help                show this help message\n");
+  std::printf("\t--iterations N        detect every file N times (default: 100)\n");
+  return -1;
+}
+
+/// In-memory stream that counts the bytes handed out by read().
+class CountingStream : public librevenge::RVNGStringStream
+{
+public:
+  CountingStream(const unsigned char *data, unsigned dataSize)
+    : librevenge::RVNGStringStream(data, dataSize)
+    , m_bytesRead(0)
+  {
+  }
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override
+  {
+    const unsigned char *const data = librevenge::RVNGStringStream::read(numBytes, numBytesRead);
+    m_bytesRead += numBytesRead;
+    return data;
+  }
+
+  unsigned long bytesRead() const
+  {
+    return m_bytesRead;
+  }
+
+private:
+  unsigned long m_bytesRead;
+};
+
+struct Totals
+{
+  unsigned files;
+  double seconds;
+  unsigned long bytesRead;
+};
+
+void printTotals(const char *const name, const Totals &totals, const unsigned iterations)
+{
+  if (totals.files == 0)
+    return;
+  const double detections = double(totals.files) * iterations;
+  std::printf("%-12s %6u files %12.2f us/file %12.0f bytes read/file\n",
+              name, totals.files, totals.seconds * 1e6 / detections, double(totals.bytesRead) / detections);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned iterations = 100;
+  std::vector<const char *> files;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (!std::strcmp(argv[i], "--iterations") && i + 1 < argc)
+      iterations = unsigned(std::max(1, std::atoi(argv[++i])));
+    else if (!std::strcmp(argv[i], "--help"))
+      return printUsage();
+    else if (argv[i][0] == '-')
+      return printUsage();
+    else
+      files.push_back(argv[i]);
+  }
+
+  if (files.empty())
+    return printUsage();
+
+  Totals supported = {0, 0, 0};
+  Totals unsupported = {0, 0, 0};
+
+  for (const auto file : files)
+  {
+    std::ifstream in(file, std::ios::binary);
+    if (!in)
+    {
+      std::fprintf(stderr, "cannot read %s\n", file);
+      continue;
+    }
+    const std::vector<unsigned char> content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    bool isSupported = false;
+    unsigned long bytesRead = 0;
+    std::chrono::duration<double> elapsed(0);
+    for (unsigned n = 0; n < iterations; ++n)
+    {
+      CountingStream input(content.data(), unsigned(content.size()));
+      const auto start = std::chrono::steady_clock::now();
+      isSupported = libqxp::QXPDocument::isSupported(&input);
+      elapsed += std::chrono::steady_clock::now() - start;
+      bytesRead += input.bytesRead();
+    }
+
+    std::printf("%-40s %-11s %12.2f us %12lu bytes read\n", file, isSupported ? "supported" : "unsupported",
+                elapsed.count() * 1e6 / iterations, bytesRead / iterations);
+
+    Totals &totals = isSupported ? supported : unsupported;
+    ++totals.files;
+    totals.seconds += elapsed.count();
+    totals.bytesRead += bytesRead;
+  }
+
+  std::printf("\n");
+  printTotals("supported", supported, iterations);
+  printTotals("unsupported", unsupported, iterations);
+  const Totals all = {supported.files + unsupported.files, supported.seconds + unsupported.seconds, supported.bytesRead + unsupported.bytesRead};
+  printTotals("all", all, iterations);
+
+  return 0;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
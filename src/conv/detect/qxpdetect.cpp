@@ -0,0 +1,438 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <librevenge/librevenge.h>
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/libqxp.h>
+
+namespace
+{
+
+using libqxp::QXPDocument;
+
+int printUsage()
+{
+  std::printf("`qxpdetect' identifies QuarkXPress documents.\n");
+  std::printf("\n");
+  std::printf("Usage: qxpdetect [OPTION] PATH...\n");
+  std::printf("\n");
+  std::printf("Directories are searched recursively. For every file, one line is\n");
+  std::printf("printed, with tab-separated path, format version, byte order, type\n");
+  std::printf("and container, or path and \"unsupported\". Lines are printed in the\n");
+  std::printf("order the files are done, not in the order they are found.\n");
+  std::printf("\n");
+  std::printf("Options:\n");
+  std::printf("\t--help                show this help message\n");
+  std::printf("\t--jobs N              number of files checked in parallel\n");
+  std::printf("\t--version             print version and exit\n");
+  std::printf("\n");
+  std::printf("Report bugs to <http://bugs.documentfoundation.org/>.\n");
+  return -1;
+}
+
+int printVersion()
+{
+  std::printf("qxpdetect " VERSION "\n");
+  return 0;
+}
+
+const char *versionName(const unsigned version)
+{
+  switch (version)
+  {
+  case 0x20:
+    return "1.x";
+  case 0x26:
+    return "2.x";
+  case 0x39:
+    return "3.1-mac";
+  case 0x3e:
+    return "3.1";
+  case 0x3f:
+    return "3.3";
+  case 0x41:
+    return "4.x";
+  case 0x42:
+    return "5.x";
+  case 0x43:
+    return "6.x";
+  case 0x44:
+    return "7.x";
+  case 0x45:
+    return "8.x";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+const char *typeName(const QXPDocument::Type type)
+{
+  switch (type)
+  {
+  case QXPDocument::TYPE_DOCUMENT:
+    return "document";
+  case QXPDocument::TYPE_TEMPLATE:
+    return "template";
+  case QXPDocument::TYPE_BOOK:
+    return "book";
+  case QXPDocument::TYPE_LIBRARY:
+    return "library";
+  default:
+    break;
+  }
+  return "unknown";
+}
+
+const char *wrapperName(const QXPDocument::Wrapper wrapper)
+{
+  switch (wrapper)
+  {
+  case QXPDocument::WRAPPER_BINHEX:
+    return "binhex";
+  case QXPDocument::WRAPPER_MACMIME:
+    return "macmime";
+  case QXPDocument::WRAPPER_ZIP:
+    return "zip";
+  case QXPDocument::WRAPPER_FORKS:
+    return "forks";
+  default:
+    break;
+  }
+  return "none";
+}
+
+/// Read-only memory-mapped file.
+class MappedFile
+{
+  // disable copying
+  MappedFile(const MappedFile &other) = delete;
+  MappedFile &operator=(const MappedFile &other) = delete;
+
+public:
+  explicit MappedFile(const char *const path)
+    : m_data(nullptr)
+    , m_size(0)
+  {
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      return;
+    struct stat info;
+    if (::fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+      void *const data = ::mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data != MAP_FAILED)
+      {
+        m_data = static_cast<const unsigned char *>(data);
+        m_size = size_t(info.st_size);
+      }
+    }
+    ::close(fd);
+  }
+
+  ~MappedFile()
+  {
+    if (m_data)
+      ::munmap(const_cast<unsigned char *>(m_data), m_size);
+  }
+
+  const unsigned char *data() const
+  {
+    return m_data;
+  }
+
+  size_t size() const
+  {
+    return m_size;
+  }
+
+private:
+  const unsigned char *m_data;
+  size_t m_size;
+};
+
+/// Stream over a memory-mapped file, without copying it.
+class MappedStream : public librevenge::RVNGInputStream
+{
+  // disable copying
+  MappedStream(const MappedStream &other) = delete;
+  MappedStream &operator=(const MappedStream &other) = delete;
+
+public:
+  explicit MappedStream(const MappedFile &file)
+    : m_data(file.data())
+    , m_size(long(file.size()))
+    , m_pos(0)
+  {
+  }
+
+  bool isStructured() override
+  {
+    return false;
+  }
+
+  unsigned subStreamCount() override
+  {
+    return 0;
+  }
+
+  const char *subStreamName(unsigned) override
+  {
+    return nullptr;
+  }
+
+  bool existsSubStream(const char *) override
+  {
+    return false;
+  }
+
+  librevenge::RVNGInputStream *getSubStreamByName(const char *) override
+  {
+    return nullptr;
+  }
+
+  librevenge::RVNGInputStream *getSubStreamById(unsigned) override
+  {
+    return nullptr;
+  }
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override
+  {
+    numBytesRead = std::min<unsigned long>(numBytes, static_cast<unsigned long>(m_size - m_pos));
+    if (numBytesRead == 0)
+      return nullptr;
+    const unsigned char *const data = m_data + m_pos;
+    m_pos += long(numBytesRead);
+    return data;
+  }
+
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override
+  {
+    if (seekType == librevenge::RVNG_SEEK_CUR)
+      offset += m_pos;
+    else if (seekType == librevenge::RVNG_SEEK_END)
+      offset += m_size;
+    if (offset < 0 || offset > m_size)
+      return -1;
+    m_pos = offset;
+    return 0;
+  }
+
+  long tell() override
+  {
+    return m_pos;
+  }
+
+  bool isEnd() override
+  {
+    return m_pos >= m_size;
+  }
+
+private:
+  const unsigned char *const m_data;
+  const long m_size;
+  long m_pos;
+};
+
+/// Paths waiting to be checked.
+class PathQueue
+{
+public:
+  PathQueue()
+    : m_mutex()
+    , m_notEmpty()
+    , m_notFull()
+    , m_paths()
+    , m_closed(false)
+  {
+  }
+
+  void push(std::string path)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // keep memory bounded when walking huge trees
+    m_notFull.wait(lock, [this]
+    {
+      return m_paths.size() < MAX_QUEUED;
+    });
+    m_paths.push_back(std::move(path));
+    m_notEmpty.notify_one();
+  }
+
+  bool pop(std::string &path)
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notEmpty.wait(lock, [this]
+    {
+      return !m_paths.empty() || m_closed;
+    });
+    if (m_paths.empty())
+      return false;
+    path = std::move(m_paths.front());
+    m_paths.pop_front();
+    m_notFull.notify_one();
+    return true;
+  }
+
+  void close()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_closed = true;
+    m_notEmpty.notify_all();
+  }
+
+private:
+  static const size_t MAX_QUEUED = 4096;
+
+  std::mutex m_mutex;
+  std::condition_variable m_notEmpty;
+  std::condition_variable m_notFull;
+  std::deque<std::string> m_paths;
+  bool m_closed;
+};
+
+void walk(const std::string &path, PathQueue &queue)
+{
+  struct stat info;
+  if (::lstat(path.c_str(), &info) != 0)
+  {
+    std::fprintf(stderr, "cannot access %s\n", path.c_str());
+    return;
+  }
+  if (S_ISREG(info.st_mode))
+  {
+    queue.push(path);
+    return;
+  }
+  if (!S_ISDIR(info.st_mode))
+    return;
+
+  DIR *const dir = ::opendir(path.c_str());
+  if (!dir)
+  {
+    std::fprintf(stderr, "cannot read directory %s\n", path.c_str());
+    return;
+  }
+  std::vector<std::string> entries;
+  while (const dirent *const entry = ::readdir(dir))
+  {
+    if (std::strcmp(entry->d_name, ".") != 0 && std::strcmp(entry->d_name, "..") != 0)
+      entries.push_back(path + "/" + entry->d_name);
+  }
+  ::closedir(dir);
+  for (const auto &entry : entries)
+    walk(entry, queue);
+}
+
+bool isStructured(const MappedFile &file)
+{
+  if (file.size() < 4)
+    return false;
+  // zip and OLE members are read through librevenge
+  return std::memcmp(file.data(), "PK\3\4", 4) == 0 || std::memcmp(file.data(), "\xd0\xcf\x11\xe0", 4) == 0;
+}
+
+std::string detect(const std::string &path)
+{
+  const MappedFile file(path.c_str());
+  if (!file.data())
+    return path + "\tunsupported\n";
+
+  std::unique_ptr<librevenge::RVNGInputStream> input;
+  if (isStructured(file))
+    input.reset(new librevenge::RVNGFileStream(path.c_str()));
+  else
+    input.reset(new MappedStream(file));
+
+  QXPDocument::Info info;
+  if (QXPDocument::getInfo(input.get(), info) != QXPDocument::RESULT_OK)
+    return path + "\tunsupported\n";
+
+  char line[128];
+  std::snprintf(line, sizeof(line), "\t%s\t%s\t%s\t%s\n", versionName(info.version), info.bigEndian ? "big" : "little",
+                typeName(info.type), wrapperName(info.wrapper));
+  return path + line;
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+    return printUsage();
+
+  unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> paths;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!std::strcmp(argv[i], "--jobs") && i + 1 < argc)
+      jobs = unsigned(std::max(1, std::atoi(argv[++i])));
+    else if (!std::strcmp(argv[i], "--version"))
+      return printVersion();
+    else if (std::strncmp(argv[i], "--", 2))
+      paths.push_back(argv[i]);
+    else
+      return printUsage();
+  }
+
+  if (paths.empty())
+    return printUsage();
+
+  PathQueue queue;
+  std::mutex outputMutex;
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i != jobs; ++i)
+  {
+    workers.emplace_back([&queue, &outputMutex]
+    {
+      std::string path;
+      while (queue.pop(path))
+      {
+        const std::string line = detect(path);
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::fputs(line.c_str(), stdout);
+      }
+    });
+  }
+
+  for (const auto &path : paths)
+    walk(path, queue);
+  queue.close();
+
+  for (auto &worker : workers)
+    worker.join();
+
+  return 0;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
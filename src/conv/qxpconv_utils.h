@@ -0,0 +1,51 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPCONV_UTILS_H_INCLUDED
+#define QXPCONV_UTILS_H_INCLUDED
+
+#include <cstdio>
+
+#include <libqxp/libqxp.h>
+
+namespace qxpconv
+{
+
+// output of the --estimate option, shared by all converters
+inline void printEstimate(const libqxp::QXPCostEstimate &estimate)
+{
+  std::printf("blocks: %u\n", estimate.blockCount);
+  std::printf("document chain: %lu\n", estimate.documentChainLength);
+  std::printf("pages: %u\n", estimate.pageCount);
+  std::printf("content: %lu\n", estimate.contentLength);
+  std::printf("cpu time: %.6f\n", estimate.cpuTime);
+  std::printf("peak memory: %lu\n", estimate.peakMemory);
+}
+
+// output of the --mem-report option, shared by all converters
+inline void printMemoryReport(const libqxp::QXPMemoryStats &stats)
+{
+  using libqxp::QXPMemoryStats;
+
+  std::fprintf(stderr, "%-10s %14s %14s\n", "memory", "current", "peak");
+  for (int i = 0; i != QXPMemoryStats::CATEGORY_COUNT; ++i)
+  {
+    const auto category = QXPMemoryStats::Category(i);
+    const QXPMemoryStats::Usage usage = stats.usage(category);
+    std::fprintf(stderr, "%-10s %14lu %14lu\n", QXPMemoryStats::categoryName(category), usage.current, usage.peak);
+  }
+  const QXPMemoryStats::Usage total = stats.total();
+  std::fprintf(stderr, "%-10s %14lu %14lu\n", "total", total.current, total.peak);
+}
+
+}
+
+#endif // QXPCONV_UTILS_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
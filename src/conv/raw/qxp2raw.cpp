@@ -11,7 +11,9 @@
 #include "config.h"
 #endif
 
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -22,6 +24,8 @@
 
 #include <libqxp/libqxp.h>
 
+#include "qxpconv_utils.h"
+
 namespace
 {
 
@@ -33,7 +37,12 @@ int printUsage()
   std::printf("\n");
   std::printf("Options:\n");
   std::printf("\t--callgraph           display the call graph nesting level\n");
+  std::printf("\t--estimate            print estimated cost of the conversion and exit\n");
   std::printf("\t--help                show this help message\n");
+  std::printf("\t--inventory           print summary of the document as JSON\n");
+  std::printf("\t--mem-report          print memory usage of the import to stderr\n");
+  std::printf("\t--threads N           parse on up to N threads, 0 for automatic\n");
+  std::printf("\t--timeout SECONDS     stop the conversion after SECONDS\n");
   std::printf("\t--version             print version and exit\n");
   std::printf("\n");
   std::printf("Report bugs to <http://bugs.documentfoundation.org/>.\n");
@@ -46,6 +55,53 @@ int printVersion()
   return 0;
 }
 
+void printJSONString(const librevenge::RVNGString &str)
+{
+  std::putchar('"');
+  for (const char *c = str.cstr(); *c; ++c)
+  {
+    if (*c == '"' || *c == '\\')
+      std::printf("\\%c", *c);
+    else if (static_cast<unsigned char>(*c) < 0x20)
+      std::printf("\\u%04x", unsigned(*c));
+    else
+      std::putchar(*c);
+  }
+  std::putchar('"');
+}
+
+void printJSONStrings(const librevenge::RVNGStringVector &strings)
+{
+  std::putchar('[');
+  for (unsigned i = 0; i != strings.size(); ++i)
+  {
+    if (i != 0)
+      std::printf(", ");
+    printJSONString(strings[i]);
+  }
+  std::putchar(']');
+}
+
+void printInventory(const libqxp::QXPInventory &inventory)
+{
+  std::printf("{\n");
+  std::printf("  \"version\": %u,\n", inventory.version);
+  std::printf("  \"pageCount\": %u,\n", inventory.pageCount);
+  std::printf("  \"pageWidth\": %g,\n", inventory.pageWidth);
+  std::printf("  \"pageHeight\": %g,\n", inventory.pageHeight);
+  std::printf("  \"fonts\": ");
+  printJSONStrings(inventory.fonts);
+  std::printf(",\n");
+  std::printf("  \"colors\": ");
+  printJSONStrings(inventory.colors);
+  std::printf(",\n");
+  std::printf("  \"pictureCount\": %u,\n", inventory.pictureCount);
+  std::printf("  \"pictureBytes\": %lu,\n", inventory.pictureBytes);
+  std::printf("  \"storyCount\": %u,\n", inventory.storyCount);
+  std::printf("  \"characterCount\": %lu\n", inventory.characterCount);
+  std::printf("}\n");
+}
+
 } // anonymous namespace
 
 using libqxp::QXPDocument;
@@ -53,6 +109,11 @@ using libqxp::QXPDocument;
 int main(int argc, char *argv[])
 {
   bool printIndentLevel = false;
+  bool printMemory = false;
+  bool estimateOnly = false;
+  bool inventoryOnly = false;
+  double timeout = 0;
+  unsigned threads = 1;
   char *file = 0;
 
   if (argc < 2)
@@ -62,6 +123,16 @@ int main(int argc, char *argv[])
   {
     if (!std::strcmp(argv[i], "--callgraph"))
       printIndentLevel = true;
+    else if (!std::strcmp(argv[i], "--estimate"))
+      estimateOnly = true;
+    else if (!std::strcmp(argv[i], "--inventory"))
+      inventoryOnly = true;
+    else if (!std::strcmp(argv[i], "--mem-report"))
+      printMemory = true;
+    else if (!std::strcmp(argv[i], "--threads") && i + 1 < argc)
+      threads = unsigned(std::atoi(argv[++i]));
+    else if (!std::strcmp(argv[i], "--timeout") && i + 1 < argc)
+      timeout = std::atof(argv[++i]);
     else if (!std::strcmp(argv[i], "--version"))
       return printVersion();
     else if (!file && std::strncmp(argv[i], "--", 2))
@@ -73,7 +144,7 @@ int main(int argc, char *argv[])
   if (!file)
     return printUsage();
 
-  librevenge::RVNGFileStream input(file);
+  libqxp::QXPFileStream input(file);
 
   QXPDocument::Type type = QXPDocument::TYPE_UNKNOWN;
   const bool supported = QXPDocument::isSupported(&input, &type);
@@ -83,9 +154,38 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  if (estimateOnly)
+  {
+    libqxp::QXPCostEstimate estimate;
+    if (QXPDocument::RESULT_OK != QXPDocument::estimateCost(&input, estimate))
+      return 1;
+    qxpconv::printEstimate(estimate);
+    return 0;
+  }
+
+  if (inventoryOnly)
+  {
+    libqxp::QXPInventory inventory;
+    if (QXPDocument::RESULT_OK != QXPDocument::getInventory(&input, inventory))
+      return 1;
+    printInventory(inventory);
+    return 0;
+  }
+
   librevenge::RVNGRawDrawingGenerator documentGenerator(printIndentLevel);
 
-  return (QXPDocument::RESULT_OK == QXPDocument::parse(&input, &documentGenerator)) ? 0 : 1;
+  libqxp::QXPMemoryStats stats;
+  libqxp::QXPParseOptions options;
+  options.setMaxThreads(threads);
+  if (timeout > 0)
+    options.setDeadline(libqxp::QXPParseOptions::Clock::now() + std::chrono::duration_cast<libqxp::QXPParseOptions::Clock::duration>(std::chrono::duration<double>(timeout)));
+  const QXPDocument::Result result = QXPDocument::parse(&input, &documentGenerator, nullptr, &stats, &options);
+  if (printMemory)
+    qxpconv::printMemoryReport(stats);
+  if (QXPDocument::RESULT_DEADLINE_EXCEEDED == result)
+    std::cerr << "ERROR: Timeout" << std::endl;
+
+  return (QXPDocument::RESULT_OK == result) ? 0 : 1;
 }
 
 /* vim:set shiftwidth=4 softtabstop=4 noexpandtab: */
@@ -22,6 +22,8 @@
 
 #include <libqxp/libqxp.h>
 
+#include "qxpconv_utils.h"
+
 namespace
 {
 
@@ -32,7 +34,9 @@ int printUsage()
   std::printf("Usage: qxp2svg [OPTION] FILE\n");
   std::printf("\n");
   std::printf("Options:\n");
+  std::printf("\t--estimate            print estimated cost of the conversion and exit\n");
   std::printf("\t--help                show this help message\n");
+  std::printf("\t--mem-report          print memory usage of the import to stderr\n");
   std::printf("\t--version             print version and exit\n");
   std::printf("\n");
   std::printf("Report bugs to <http://bugs.documentfoundation.org/>.\n");
@@ -45,7 +49,6 @@ int printVersion()
   return 0;
 }
 
-
 } // anonymous namespace
 
 using libqxp::QXPDocument;
@@ -56,10 +59,16 @@ int main(int argc, char *argv[])
     return printUsage();
 
   char *file = 0;
+  bool printMemory = false;
+  bool estimateOnly = false;
 
   for (int i = 1; i < argc; i++)
   {
-    if (!std::strcmp(argv[i], "--version"))
+    if (!std::strcmp(argv[i], "--estimate"))
+      estimateOnly = true;
+    else if (!std::strcmp(argv[i], "--mem-report"))
+      printMemory = true;
+    else if (!std::strcmp(argv[i], "--version"))
       return printVersion();
     else if (!file && std::strncmp(argv[i], "--", 2))
       file = argv[i];
@@ -70,7 +79,7 @@ int main(int argc, char *argv[])
   if (!file)
     return printUsage();
 
-  librevenge::RVNGFileStream input(file);
+  libqxp::QXPFileStream input(file);
 
   QXPDocument::Type type = QXPDocument::TYPE_UNKNOWN;
   const bool supported = QXPDocument::isSupported(&input, &type);
@@ -80,9 +89,23 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  if (estimateOnly)
+  {
+    libqxp::QXPCostEstimate estimate;
+    if (QXPDocument::RESULT_OK != QXPDocument::estimateCost(&input, estimate))
+      return 1;
+    qxpconv::printEstimate(estimate);
+    return 0;
+  }
+
   librevenge::RVNGStringVector vec;
   librevenge::RVNGSVGDrawingGenerator generator(vec, "");
-  auto result = QXPDocument::parse(&input, &generator);
+  libqxp::QXPMemoryStats stats;
+  auto result = QXPDocument::parse(&input, &generator, nullptr, &stats);
+  for (unsigned i = 0; i != vec.size(); ++i)
+    stats.allocate(libqxp::QXPMemoryStats::CATEGORY_OUTPUT, vec[i].size());
+  if (printMemory)
+    qxpconv::printMemoryReport(stats);
   if (QXPDocument::RESULT_OK != result || vec.empty() || vec[0].empty())
   {
     std::cerr << "ERROR: SVG Generation failed!" << std::endl;
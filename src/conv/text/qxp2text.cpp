@@ -22,6 +22,8 @@
 
 #include <libqxp/libqxp.h>
 
+#include "qxpconv_utils.h"
+
 namespace
 {
 
@@ -32,7 +34,10 @@ int printUsage()
   std::printf("Usage: qxp2text [OPTION] FILE\n");
   std::printf("\n");
   std::printf("Options:\n");
+  std::printf("\t--estimate            print estimated cost of the conversion and exit\n");
   std::printf("\t--help                show this help message\n");
+  std::printf("\t--mem-report          print memory usage of the import to stderr\n");
+  std::printf("\t--stories             print only text of stories, in reading order\n");
   std::printf("\t--version             print version and exit\n");
   std::printf("\n");
   std::printf("Report bugs to <http://bugs.documentfoundation.org/>.\n");
@@ -45,6 +50,16 @@ int printVersion()
   return 0;
 }
 
+class StoryPrinter : public libqxp::QXPTextSink
+{
+public:
+  void insertStory(const char *text, unsigned long length) override
+  {
+    std::fwrite(text, 1, length, stdout);
+    std::puts("");
+  }
+};
+
 } // anonymous namespace
 
 using libqxp::QXPDocument;
@@ -55,10 +70,19 @@ int main(int argc, char *argv[])
     return printUsage();
 
   char *file = 0;
+  bool printMemory = false;
+  bool estimateOnly = false;
+  bool storiesOnly = false;
 
   for (int i = 1; i < argc; i++)
   {
-    if (!std::strcmp(argv[i], "--version"))
+    if (!std::strcmp(argv[i], "--estimate"))
+      estimateOnly = true;
+    else if (!std::strcmp(argv[i], "--mem-report"))
+      printMemory = true;
+    else if (!std::strcmp(argv[i], "--stories"))
+      storiesOnly = true;
+    else if (!std::strcmp(argv[i], "--version"))
       return printVersion();
     else if (!file && std::strncmp(argv[i], "--", 2))
       file = argv[i];
@@ -69,7 +93,7 @@ int main(int argc, char *argv[])
   if (!file)
     return printUsage();
 
-  librevenge::RVNGFileStream input(file);
+  libqxp::QXPFileStream input(file);
 
   QXPDocument::Type type = QXPDocument::TYPE_UNKNOWN;
   const bool supported = QXPDocument::isSupported(&input, &type);
@@ -79,10 +103,32 @@ int main(int argc, char *argv[])
     return 1;
   }
 
+  if (estimateOnly)
+  {
+    libqxp::QXPCostEstimate estimate;
+    if (QXPDocument::RESULT_OK != QXPDocument::estimateCost(&input, estimate))
+      return 1;
+    qxpconv::printEstimate(estimate);
+    return 0;
+  }
+
+  if (storiesOnly)
+  {
+    StoryPrinter printer;
+    return QXPDocument::RESULT_OK == QXPDocument::extractText(&input, &printer) ? 0 : 1;
+  }
+
   librevenge::RVNGStringVector pages;
   librevenge::RVNGTextDrawingGenerator documentGenerator(pages);
 
-  if (QXPDocument::RESULT_OK != QXPDocument::parse(&input, &documentGenerator))
+  libqxp::QXPMemoryStats stats;
+  const QXPDocument::Result result = QXPDocument::parse(&input, &documentGenerator, nullptr, &stats);
+  for (unsigned i = 0; i != pages.size(); ++i)
+    stats.allocate(libqxp::QXPMemoryStats::CATEGORY_OUTPUT, pages[i].size());
+  if (printMemory)
+    qxpconv::printMemoryReport(stats);
+
+  if (QXPDocument::RESULT_OK != result)
     return 1;
 
   for (unsigned i = 0; i != pages.size(); ++i)
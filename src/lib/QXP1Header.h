@@ -31,6 +31,16 @@ public:
     return m_pages;
   }
 
+  unsigned pagesCount() const override
+  {
+    return m_pages;
+  }
+
+  unsigned masterPagesCount() const override
+  {
+    return 2;
+  }
+
   double pageHeight() const
   {
     return m_pageHeight;
@@ -55,6 +55,21 @@ shared_ptr<T> createLine(const QXP1Parser::ObjectHeader &header)
   return line;
 }
 
+bool isLastObject(const unsigned lastObject)
+{
+  switch (lastObject)
+  {
+  case 0: // basic object
+  case 1: // main textbox
+    return false;
+  case 2: // last object (can be the main text box if last)
+    return true;
+  default:
+    QXP_DEBUG_MSG(("QXP1Parser: unknown 'last object' value %d, cannot continue\n", lastObject));
+    throw ParseError();
+  }
+}
+
 }
 
 QXP1Parser::QXP1Parser(const std::shared_ptr<librevenge::RVNGInputStream> &input, librevenge::RVNGDrawingInterface *painter, const std::shared_ptr<QXP1Header> &header)
@@ -96,32 +111,75 @@ bool QXP1Parser::parseDocument(const std::shared_ptr<librevenge::RVNGInputStream
 
 bool QXP1Parser::parsePages(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXPCollector &collector)
 {
+  PageCheckpoint checkpoint = firstPageCheckpoint(stream);
+
+  for (unsigned i = 0; i < 2+m_header->pages(); ++i)
+  {
+    const bool isMaster = i < 2;
+
+    // don't output master pages, everything is included in normal pages
+    if (isMaster || !collector.isPageNeeded(i - 2))
+      skipPageAt(stream, checkpoint, isMaster ? nullptr : &collector, nullptr);
+    else
+      parsePageAt(stream, checkpoint, collector);
+
+    if (!isMaster)
+      pageDone();
+  }
+
+  return true;
+}
+
+QXPParser::PageCheckpoint QXP1Parser::firstPageCheckpoint(const std::shared_ptr<librevenge::RVNGInputStream> &stream) const
+{
+  // there is no obfuscation before 3.1
+  return PageCheckpoint{static_cast<unsigned long>(stream->tell()), 0, 0};
+}
+
+bool QXP1Parser::parsePageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector &collector)
+{
+  checkLimits();
+
   Page page;
   page.pageSettings.resize(1);
   page.pageSettings[0].offset.bottom = m_header->pageHeight();
   page.pageSettings[0].offset.right = m_header->pageWidth();
 
-  QXPDummyCollector dummyCollector;
-  for (unsigned i = 0; i < 2+m_header->pages(); ++i)
-  {
-    // don't output master pages, everything is included in normal pages
-    QXPCollector &coll = i < 2 ? dummyCollector : collector;
+  seek(stream, checkpoint.offset);
+  const bool empty = parsePage(stream);
+  bool last = !empty;
 
-    const bool empty = parsePage(stream);
-    coll.startPage(page);
-    bool last = !empty;
-    unsigned index=1;
-    while (!last)
-    {
-      // reserve index 1 for the main textbox
-      last = parseObject(stream, coll, ++index);
-    }
-    coll.endPage();
+  collector.startPage(page);
+  unsigned index=1;
+  while (!last)
+  {
+    checkLimits();
+    // reserve index 1 for the main textbox
+    last = parseObject(stream, collector, ++index);
   }
+  collector.endPage();
 
+  checkpoint.offset = static_cast<unsigned long>(stream->tell());
   return true;
 }
 
+void QXP1Parser::skipPageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector *const storyCollector, QXPReadaheadPlanner * /*readahead*/)
+{
+  checkLimits();
+
+  seek(stream, checkpoint.offset);
+  const bool empty = parsePage(stream);
+  bool last = !empty;
+
+  while (!last)
+  {
+    checkLimits();
+    last = skipObject(stream, storyCollector);
+  }
+
+  checkpoint.offset = static_cast<unsigned long>(stream->tell());
+}
+
 void QXP1Parser::parseColors(const std::shared_ptr<librevenge::RVNGInputStream> &stream)
 {
   const unsigned end = readRecordEndOffset(stream);
@@ -243,6 +301,79 @@ bool QXP1Parser::parseObject(const std::shared_ptr<librevenge::RVNGInputStream>
 #ifdef DEBUG
   std::cout << std::hex << input->tell() << std::dec << "\n";
 #endif
+  const auto object = parseObjectHeader(input);
+
+  unsigned lastObject;
+  switch (object.shapeType)
+  {
+  case ShapeType::LINE:
+  case ShapeType::ORTHOGONAL_LINE:
+    parseLine(input, collector, object, defZIndex, lastObject);
+    break;
+  case ShapeType::RECTANGLE:
+  case ShapeType::CORNERED_RECTANGLE:
+  case ShapeType::OVAL:
+    if (object.contentType == ContentType::TEXT)
+      parseTextBox(input, collector, object, defZIndex, lastObject);
+    else
+      parsePictureBox(input, collector, object, defZIndex, lastObject);
+    break;
+  default:
+    QXP_DEBUG_MSG(("QXP1Parser::parseObject: unknown object shape, cannot continue\n"));
+    throw ParseError();
+  }
+
+  return isLastObject(lastObject);
+}
+
+bool QXP1Parser::skipObject(const std::shared_ptr<librevenge::RVNGInputStream> &input, QXPCollector *const storyCollector)
+{
+  const auto object = parseObjectHeader(input);
+
+  switch (object.shapeType)
+  {
+  case ShapeType::LINE:
+  case ShapeType::ORTHOGONAL_LINE:
+    skip(input, 25);
+    break;
+  case ShapeType::RECTANGLE:
+  case ShapeType::CORNERED_RECTANGLE:
+  case ShapeType::OVAL:
+    if (object.contentType == ContentType::TEXT)
+    {
+      skip(input, 24);
+      if (readU8(input))
+        skip(input, 3);
+      if (object.contentIndex == 0)
+        skip(input, 12);
+      // later boxes of the story may be on a page that is parsed
+      if (storyCollector && object.contentIndex != 0 && object.textOffset == 0)
+        parseText(object.contentIndex, object.linkIndex, *storyCollector);
+    }
+    else
+    {
+      skip(input, 24);
+      const unsigned index = readU32(input, true);
+      skip(input, m_header->version() >= QXPVersion::QXP_2 ? 27 : 17);
+      const unsigned lastObject = readU8(input);
+      if (index)
+      {
+        for (int i = 0; i < 2; ++i)
+          skip(input, readU16(input, true));
+      }
+      return isLastObject(lastObject);
+    }
+    break;
+  default:
+    QXP_DEBUG_MSG(("QXP1Parser::skipObject: unknown object shape, cannot continue\n"));
+    throw ParseError();
+  }
+
+  return isLastObject(readU8(input));
+}
+
+QXP1Parser::ObjectHeader QXP1Parser::parseObjectHeader(const std::shared_ptr<librevenge::RVNGInputStream> &input)
+{
   ObjectHeader object;
   const unsigned type = readU8(input);
   if (m_header->version()>=QXPVersion::QXP_2)
@@ -329,42 +460,12 @@ bool QXP1Parser::parseObject(const std::shared_ptr<librevenge::RVNGInputStream>
   const unsigned colorId = readU8(input);
   const auto &color = getColor(colorId).applyShade(getShade(shadeId));
 
-  if (type<2 || !transparent)
+  if (object.contentType == ContentType::NONE || !transparent)
   {
     object.fill = color;
   }
 
-  unsigned lastObject;
-  switch (object.shapeType)
-  {
-  case ShapeType::LINE:
-  case ShapeType::ORTHOGONAL_LINE:
-    parseLine(input, collector, object, defZIndex, lastObject);
-    break;
-  case ShapeType::RECTANGLE:
-  case ShapeType::CORNERED_RECTANGLE:
-  case ShapeType::OVAL:
-    if (object.contentType == ContentType::TEXT)
-      parseTextBox(input, collector, object, defZIndex, lastObject);
-    else
-      parsePictureBox(input, collector, object, defZIndex, lastObject);
-    break;
-  default:
-    QXP_DEBUG_MSG(("QXP1Parser::parseObject: unknown object type %d, cannot continue\n", type));
-    throw ParseError();
-  }
-
-  switch (lastObject)
-  {
-  case 0: // basic object
-  case 1: // main textbox
-    return false;
-  case 2: // last object (can be the main text box if last)
-    return true;
-  default:
-    QXP_DEBUG_MSG(("QXP1Parser::parseObject: unknown 'last object' value %d, cannot continue\n", lastObject));
-    throw ParseError();
-  }
+  return object;
 }
 
 void QXP1Parser::parseLine(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXPCollector &collector, QXP1Parser::ObjectHeader const &header, unsigned defZIndex, unsigned &lastObject)
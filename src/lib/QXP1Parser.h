@@ -61,6 +61,9 @@ public:
 private:
   bool parseDocument(const std::shared_ptr<librevenge::RVNGInputStream> &docStream, QXPCollector &collector) override;
   bool parsePages(const std::shared_ptr<librevenge::RVNGInputStream> &pagesStream, QXPCollector &collector) override;
+  PageCheckpoint firstPageCheckpoint(const std::shared_ptr<librevenge::RVNGInputStream> &stream) const override;
+  bool parsePageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector &collector) override;
+  void skipPageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector *storyCollector, QXPReadaheadPlanner *readahead) override;
 
   void parseColors(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
   CharFormat parseCharFormat(const std::shared_ptr<librevenge::RVNGInputStream> &stream) override;
@@ -69,6 +72,9 @@ private:
 
   bool parsePage(const std::shared_ptr<librevenge::RVNGInputStream> &input);
   bool parseObject(const std::shared_ptr<librevenge::RVNGInputStream> &input, QXPCollector &collector, unsigned defZIndex);
+  // moves past an object, without building it; story heads are passed to storyCollector, if any
+  bool skipObject(const std::shared_ptr<librevenge::RVNGInputStream> &input, QXPCollector *storyCollector);
+  ObjectHeader parseObjectHeader(const std::shared_ptr<librevenge::RVNGInputStream> &input);
 
   void parseLine(const std::shared_ptr<librevenge::RVNGInputStream> &input, QXPCollector &collector, ObjectHeader const &header, unsigned defZIndex, unsigned &lastObject);
   void parsePictureBox(const std::shared_ptr<librevenge::RVNGInputStream> &input, QXPCollector &collector, ObjectHeader const &header, unsigned defZIndex, unsigned &lastObject);
@@ -23,6 +23,11 @@ void QXP33Deobfuscator::next()
   m_seed += m_increment;
 }
 
+uint16_t QXP33Deobfuscator::increment() const
+{
+  return m_increment;
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
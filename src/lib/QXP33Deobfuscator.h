@@ -23,6 +23,8 @@ public:
 
   void next();
 
+  uint16_t increment() const;
+
 private:
   uint16_t m_increment;
 };
@@ -66,12 +66,12 @@ std::unique_ptr<QXPParser> QXP33Header::createParser(const std::shared_ptr<libre
   return std::unique_ptr<QXPParser>(new QXP33Parser(input, painter, shared_from_this()));
 }
 
-uint16_t QXP33Header::pagesCount() const
+unsigned QXP33Header::pagesCount() const
 {
   return m_pagesCount;
 }
 
-uint16_t QXP33Header::masterPagesCount() const
+unsigned QXP33Header::masterPagesCount() const
 {
   return m_masterPagesCount;
 }
@@ -28,8 +28,8 @@ public:
 
   std::unique_ptr<QXPParser> createParser(const std::shared_ptr<librevenge::RVNGInputStream> &input, librevenge::RVNGDrawingInterface *painter) override;
 
-  uint16_t pagesCount() const;
-  uint16_t masterPagesCount() const;
+  unsigned pagesCount() const override;
+  unsigned masterPagesCount() const override;
   uint16_t seed() const;
   uint16_t increment() const;
   const QXPDocumentProperties &documentProperties() const;
@@ -12,6 +12,7 @@
 #include "QXP33Deobfuscator.h"
 #include "QXP33Header.h"
 #include "QXPCollector.h"
+#include "QXPReadaheadPlanner.h"
 #include "QXPTypes.h"
 
 namespace libqxp
@@ -63,10 +64,15 @@ shared_ptr<T> createLine(const QXP33Parser::ObjectHeader &header)
 }
 
 QXP33Parser::QXP33Parser(const std::shared_ptr<librevenge::RVNGInputStream> &input, librevenge::RVNGDrawingInterface *painter, const std::shared_ptr<QXP33Header> &header)
+  : QXP33Parser(input, painter, header, true)
+{
+}
+
+QXP33Parser::QXP33Parser(const std::shared_ptr<librevenge::RVNGInputStream> &input, librevenge::RVNGDrawingInterface *painter, const std::shared_ptr<QXP33Header> &header, const bool readIndexSize)
   : QXPParser(input, painter, header)
   , m_header(header)
 {
-  if (m_header && m_input)
+  if (readIndexSize && m_header && m_input)
   {
     if (m_header->version()==QXP_33 && m_header->isBigEndian())
     {
@@ -115,31 +121,87 @@ bool QXP33Parser::parseDocument(const std::shared_ptr<librevenge::RVNGInputStrea
 
 bool QXP33Parser::parsePages(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXPCollector &collector)
 {
-  QXP33Deobfuscator deobfuscate(m_header->seed(), m_header->increment());
-  QXPDummyCollector dummyCollector;
+  const unsigned threads = pageThreads(m_header->pagesCount());
+  std::vector<PageCheckpoint> checkpoints;
+  QXPReadaheadPlanner readahead(m_blockParser.blockLength(), m_blockParser.blockCount(), collector.textNeeds() != ContentNeeds::NONE, collector.pictureNeeds() != ContentNeeds::NONE);
+  PageCheckpoint checkpoint = firstPageCheckpoint(stream);
 
   for (unsigned ind = 0; ind < m_header->pagesCount() + m_header->masterPagesCount(); ++ind)
   {
+    const bool isMaster = ind < m_header->masterPagesCount();
+    const bool isNeeded = !isMaster && collector.isPageNeeded(ind - m_header->masterPagesCount());
+
+    // with more threads, this is just a quick pass to find where pages start
+    if (isNeeded && threads > 1)
+      checkpoints.push_back(checkpoint);
+
     // don't output master pages, everything is included in normal pages
-    QXPCollector &coll = ind < m_header->masterPagesCount() ? dummyCollector : collector;
+    if (!isNeeded || threads > 1)
+      skipPageAt(stream, checkpoint, isMaster || isNeeded ? nullptr : &collector, isNeeded ? &readahead : nullptr);
+    else
+      parsePageAt(stream, checkpoint, collector);
 
-    auto page = parsePage(stream);
-    coll.startPage(page);
+    // pages parsed concurrently are done once they are collected
+    if (!isMaster && !(isNeeded && threads > 1))
+      pageDone();
+  }
 
-    for (unsigned i = 0; i < page.objectsCount; ++i)
-    {
+  readAhead(readahead);
+  return parsePagesConcurrently(stream, checkpoints, threads, collector);
+}
 
-      parseObject(stream, deobfuscate, coll, page, i);
-      deobfuscate.next();
-    }
+QXPParser::PageCheckpoint QXP33Parser::firstPageCheckpoint(const std::shared_ptr<librevenge::RVNGInputStream> &stream) const
+{
+  return PageCheckpoint{static_cast<unsigned long>(stream->tell()), m_header->seed(), m_header->increment()};
+}
 
-    m_groupObjects.clear();
-    coll.endPage();
+bool QXP33Parser::parsePageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector &collector)
+{
+  checkLimits();
+  QXP33Deobfuscator deobfuscate(checkpoint.seed, checkpoint.increment);
+
+  seek(stream, checkpoint.offset);
+  auto page = parsePage(stream);
+  collector.startPage(page);
+
+  for (unsigned i = 0; i < page.objectsCount; ++i)
+  {
+    checkLimits();
+    parseObject(stream, deobfuscate, collector, page, i);
+    deobfuscate.next();
   }
 
+  m_groupObjects.clear();
+  collector.endPage();
+
+  checkpoint = PageCheckpoint{static_cast<unsigned long>(stream->tell()), deobfuscate.seed(), deobfuscate.increment()};
   return true;
 }
 
+void QXP33Parser::skipPageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector *const storyCollector, QXPReadaheadPlanner *const readahead)
+{
+  checkLimits();
+  QXP33Deobfuscator deobfuscate(checkpoint.seed, checkpoint.increment);
+
+  seek(stream, checkpoint.offset);
+  auto page = parsePage(stream);
+
+  for (unsigned i = 0; i < page.objectsCount; ++i)
+  {
+    checkLimits();
+    skipObject(stream, deobfuscate, page, storyCollector, readahead);
+    deobfuscate.next();
+  }
+
+  checkpoint = PageCheckpoint{static_cast<unsigned long>(stream->tell()), deobfuscate.seed(), deobfuscate.increment()};
+}
+
+std::unique_ptr<QXPParser> QXP33Parser::createPageParser() const
+{
+  // the input may be in use by background tasks, so it is not read here
+  return std::unique_ptr<QXPParser>(new QXP33Parser(m_input, nullptr, m_header, false));
+}
+
 void QXP33Parser::parseColors(const std::shared_ptr<librevenge::RVNGInputStream> &stream)
 {
   const unsigned end = readRecordEndOffset(stream);
@@ -300,6 +362,113 @@ void QXP33Parser::parseObject(const std::shared_ptr<librevenge::RVNGInputStream>
   }
 }
 
+void QXP33Parser::skipObject(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP33Deobfuscator &deobfuscate, const Page &page, QXPCollector *const storyCollector, QXPReadaheadPlanner *const readahead)
+{
+  const auto header = parseObjectHeader(stream, deobfuscate);
+
+  switch (header.contentType)
+  {
+  case ContentType::NONE:
+    switch (header.shapeType)
+    {
+    case ShapeType::LINE:
+    case ShapeType::ORTHOGONAL_LINE:
+      skip(stream, 6);
+      break;
+    case ShapeType::RECTANGLE:
+    case ShapeType::CORNERED_RECTANGLE:
+    case ShapeType::OVAL:
+    case ShapeType::POLYGON:
+    {
+      skip(stream, 14);
+      const unsigned runaroundId = readU32(stream, be);
+      skip(stream, 74);
+      if (header.shapeType == ShapeType::POLYGON)
+        skipPolygonData(stream);
+      if (runaroundId != 0)
+        skipRecord(stream);
+      break;
+    }
+    default:
+      QXP_DEBUG_MSG(("Unsupported shape\n"));
+      throw GenericException();
+    }
+    break;
+  case ContentType::PICTURE:
+  {
+    if (readahead)
+      readahead->addPicture(header.contentIndex);
+    skip(stream, 14);
+    unsigned runaroundId = 0;
+    unsigned fileInfoId = 0;
+    if (m_header->version() == QXP_33)
+    {
+      runaroundId = readU32(stream, be);
+      skip(stream, 2);
+    }
+    else
+    {
+      skip(stream, 10);
+    }
+    fileInfoId = readU32(stream, be);
+    skip(stream, 14 + 46);
+    const unsigned unknownId = readU32(stream, be);
+    skip(stream, 4);
+    if (header.shapeType == ShapeType::POLYGON)
+      skipPolygonData(stream);
+    if (fileInfoId != 0)
+      skipRecord(stream);
+    if (runaroundId != 0)
+      skipRecord(stream);
+    if (unknownId != 0)
+      skipRecord(stream);
+    break;
+  }
+  case ContentType::TEXT:
+  {
+    if (readahead)
+      readahead->addText(header.contentIndex);
+    skip(stream, 14);
+    const unsigned runaroundId = readU32(stream, be);
+    const unsigned offsetIntoText = readU32(stream, be);
+    skip(stream, 54);
+    if (header.shapeType == ShapeType::POLYGON)
+      skipPolygonData(stream);
+    if (header.contentIndex == 0 || offsetIntoText == 0)
+    {
+      skip(stream, 4);
+      const unsigned fileInfoId = readU32(stream, be);
+      skip(stream, 4);
+      if (fileInfoId != 0)
+        skipFileInfo(stream);
+      if (header.contentIndex == 0)
+        skip(stream, 12);
+    }
+    if (runaroundId != 0)
+      skipRecord(stream);
+    // later boxes of the story may be on a page that is parsed
+    if (storyCollector && header.contentIndex != 0 && offsetIntoText == 0)
+      parseText(header.contentIndex, header.linkId, *storyCollector);
+    break;
+  }
+  case ContentType::OBJECTS:
+  {
+    skip(stream, 10);
+    const unsigned count = readU16(stream, be);
+    if (count > page.objectsCount - 1)
+    {
+      QXP_DEBUG_MSG(("Invalid group elements count %u\n", count));
+      throw ParseError();
+    }
+    skip(stream, 6 + 4 * count);
+    break;
+  }
+  default:
+    QXP_DEBUG_MSG(("Unsupported content\n"));
+    throw GenericException();
+  }
+}
+
 QXP33Parser::ObjectHeader QXP33Parser::parseObjectHeader(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP33Deobfuscator &deobfuscate)
 {
   ObjectHeader result;
@@ -748,6 +917,18 @@ std::vector<Point> QXP33Parser::readPolygonData(const std::shared_ptr<librevenge
   return points;
 }
 
+void QXP33Parser::skipPolygonData(const std::shared_ptr<librevenge::RVNGInputStream> &stream)
+{
+  const unsigned length = readU32(stream, be);
+  if (length < 18 || length > getRemainingLength(stream))
+  {
+    QXP_DEBUG_MSG(("Invalid polygon data length %u\n", length));
+    throw ParseError();
+  }
+  // only whole points are read
+  skip(stream, 18 + (length - 18) / 8 * 8);
+}
+
 std::string QXP33Parser::readName(const std::shared_ptr<librevenge::RVNGInputStream> &stream)
 {
   const long start = stream->tell();
@@ -71,10 +71,17 @@ public:
   };
 
 private:
+  // page parsers share the header, which the main parser has already completed
+  QXP33Parser(const std::shared_ptr<librevenge::RVNGInputStream> &input, librevenge::RVNGDrawingInterface *painter, const std::shared_ptr<QXP33Header> &header, bool readIndexSize);
+
   const std::shared_ptr<QXP33Header> m_header;
 
   bool parseDocument(const std::shared_ptr<librevenge::RVNGInputStream> &docStream, QXPCollector &collector) override;
   bool parsePages(const std::shared_ptr<librevenge::RVNGInputStream> &pagesStream, QXPCollector &collector) override;
+  PageCheckpoint firstPageCheckpoint(const std::shared_ptr<librevenge::RVNGInputStream> &stream) const override;
+  bool parsePageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector &collector) override;
+  void skipPageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector *storyCollector, QXPReadaheadPlanner *readahead) override;
+  std::unique_ptr<QXPParser> createPageParser() const override;
 
   void parseColors(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
   CharFormat parseCharFormat(const std::shared_ptr<librevenge::RVNGInputStream> &stream) override;
@@ -84,6 +91,8 @@ private:
   Page parsePage(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
 
   void parseObject(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP33Deobfuscator &deobfuscate, QXPCollector &collector, const Page &page, unsigned index);
+  // moves past an object, without building it; story heads are passed to storyCollector, if any
+  void skipObject(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP33Deobfuscator &deobfuscate, const Page &page, QXPCollector *storyCollector, QXPReadaheadPlanner *readahead);
   ObjectHeader parseObjectHeader(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP33Deobfuscator &deobfuscate);
   void readObjectFlags(const std::shared_ptr<librevenge::RVNGInputStream> &stream, bool &noColor, bool &noRunaround);
   void parseLine(const std::shared_ptr<librevenge::RVNGInputStream> &stream, const ObjectHeader &header, QXPCollector &collector);
@@ -94,6 +103,7 @@ private:
 
   Frame readFrame(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
   std::vector<Point> readPolygonData(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
+  void skipPolygonData(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
 
   std::string readName(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
 };
@@ -61,6 +61,11 @@ void QXP4Deobfuscator::nextShift(uint16_t count)
   m_seed = shift(m_seed, count & 0xf);
 }
 
+uint16_t QXP4Deobfuscator::increment() const
+{
+  return m_increment;
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -25,6 +25,8 @@ public:
   void nextRev();
   void nextShift(uint16_t count);
 
+  uint16_t increment() const;
+
 private:
   uint16_t m_increment;
 };
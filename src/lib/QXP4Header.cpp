@@ -89,12 +89,12 @@ std::unique_ptr<QXPParser> QXP4Header::createParser(const std::shared_ptr<librev
   return std::unique_ptr<QXPParser>(new QXP4Parser(input, painter, shared_from_this()));
 }
 
-uint16_t QXP4Header::pagesCount() const
+unsigned QXP4Header::pagesCount() const
 {
   return m_pagesCount;
 }
 
-uint16_t QXP4Header::masterPagesCount() const
+unsigned QXP4Header::masterPagesCount() const
 {
   return m_masterPagesCount;
 }
@@ -17,6 +17,7 @@
 #include "QXP4Header.h"
 #include "QXPCollector.h"
 #include "QXPMemoryStream.h"
+#include "QXPReadaheadPlanner.h"
 
 namespace libqxp
 {
@@ -95,30 +96,86 @@ bool QXP4Parser::parseDocument(const std::shared_ptr<librevenge::RVNGInputStream
 
 bool QXP4Parser::parsePages(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXPCollector &collector)
 {
-  QXP4Deobfuscator deobfuscate(m_header->seed(), m_header->increment());
-  QXPDummyCollector dummyCollector;
+  const unsigned threads = pageThreads(m_header->pagesCount());
+  std::vector<PageCheckpoint> checkpoints;
+  QXPReadaheadPlanner readahead(m_blockParser.blockLength(), m_blockParser.blockCount(), collector.textNeeds() != ContentNeeds::NONE, collector.pictureNeeds() != ContentNeeds::NONE);
+  PageCheckpoint checkpoint = firstPageCheckpoint(stream);
 
   for (unsigned ind = 0; ind < m_header->pagesCount() + m_header->masterPagesCount(); ++ind)
   {
+    const bool isMaster = ind < m_header->masterPagesCount();
+    const bool isNeeded = !isMaster && collector.isPageNeeded(ind - m_header->masterPagesCount());
+
+    // with more threads, this is just a quick pass to find where pages start
+    if (isNeeded && threads > 1)
+      checkpoints.push_back(checkpoint);
+
     // don't output master pages, everything is included in normal pages
-    QXPCollector &coll = ind < m_header->masterPagesCount() ? dummyCollector : collector;
+    if (!isNeeded || threads > 1)
+      skipPageAt(stream, checkpoint, isMaster || isNeeded ? nullptr : &collector, isNeeded ? &readahead : nullptr);
+    else
+      parsePageAt(stream, checkpoint, collector);
 
-    auto page = parsePage(stream, deobfuscate);
-    coll.startPage(page);
-    deobfuscate.nextRev();
+    // pages parsed concurrently are done once they are collected
+    if (!isMaster && !(isNeeded && threads > 1))
+      pageDone();
+  }
 
-    for (unsigned i = 0; i < page.objectsCount; ++i)
-    {
-      parseObject(stream, deobfuscate, coll, page, i);
-    }
+  readAhead(readahead);
+  return parsePagesConcurrently(stream, checkpoints, threads, collector);
+}
 
-    m_groupObjects.clear();
-    coll.endPage();
+QXPParser::PageCheckpoint QXP4Parser::firstPageCheckpoint(const std::shared_ptr<librevenge::RVNGInputStream> &stream) const
+{
+  return PageCheckpoint{static_cast<unsigned long>(stream->tell()), m_header->seed(), m_header->increment()};
+}
+
+bool QXP4Parser::parsePageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector &collector)
+{
+  checkLimits();
+  QXP4Deobfuscator deobfuscate(checkpoint.seed, checkpoint.increment);
+
+  seek(stream, checkpoint.offset);
+  auto page = parsePage(stream, deobfuscate);
+  collector.startPage(page);
+  deobfuscate.nextRev();
+
+  for (unsigned i = 0; i < page.objectsCount; ++i)
+  {
+    checkLimits();
+    parseObject(stream, deobfuscate, collector, page, i);
   }
 
+  m_groupObjects.clear();
+  collector.endPage();
+
+  checkpoint = PageCheckpoint{static_cast<unsigned long>(stream->tell()), deobfuscate.seed(), deobfuscate.increment()};
   return true;
 }
 
+void QXP4Parser::skipPageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector *const storyCollector, QXPReadaheadPlanner *const readahead)
+{
+  checkLimits();
+  QXP4Deobfuscator deobfuscate(checkpoint.seed, checkpoint.increment);
+
+  seek(stream, checkpoint.offset);
+  auto page = parsePage(stream, deobfuscate);
+  deobfuscate.nextRev();
+
+  for (unsigned i = 0; i < page.objectsCount; ++i)
+  {
+    checkLimits();
+    skipObject(stream, deobfuscate, page, storyCollector, readahead);
+  }
+
+  checkpoint = PageCheckpoint{static_cast<unsigned long>(stream->tell()), deobfuscate.seed(), deobfuscate.increment()};
+}
+
+std::unique_ptr<QXPParser> QXP4Parser::createPageParser() const
+{
+  return std::unique_ptr<QXPParser>(new QXP4Parser(m_input, nullptr, m_header));
+}
+
 void QXP4Parser::parseColors(const std::shared_ptr<librevenge::RVNGInputStream> &docStream)
 {
   unsigned length = readU32(docStream, be);
@@ -262,7 +319,7 @@ void QXP4Parser::parseLineStyles(const std::shared_ptr<librevenge::RVNGInputStre
       skip(stream, 168);
 
       const unsigned id = readU16(stream, be);
-      auto &result = (m_lineStyles[id] = LineStyle());
+      auto &result = ((*m_lineStyles)[id] = LineStyle());
 
       result.isStripe = readU8(stream) == 1;
       skip(stream, 1);
@@ -549,6 +606,155 @@ void QXP4Parser::parseObject(const std::shared_ptr<librevenge::RVNGInputStream>
   deobfuscate.next(uint16_t(header.contentIndex));
 }
 
+void QXP4Parser::skipObject(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP4Deobfuscator &deobfuscate, const Page &page, QXPCollector *const storyCollector, QXPReadaheadPlanner *const readahead)
+{
+  const auto header = parseObjectHeader(stream, deobfuscate);
+
+  // all kinds of objects start with frame, runaround and either
+  // bounding box or the part of record preceding bezier data
+  switch (header.contentType)
+  {
+  case ContentType::NONE:
+    skip(stream, 108);
+    switch (header.shapeType)
+    {
+    case ShapeType::LINE:
+    case ShapeType::ORTHOGONAL_LINE:
+      break;
+    case ShapeType::BEZIER_LINE:
+      skipRecord(stream); // bezier data
+      break;
+    case ShapeType::BEZIER_BOX:
+      if (header.gradientId != 0)
+        skipRecord(stream);
+      skipRecord(stream); // bezier data
+      break;
+    case ShapeType::RECTANGLE:
+    case ShapeType::ROUNDED_RECTANGLE:
+    case ShapeType::CONCAVE_RECTANGLE:
+    case ShapeType::BEVELED_RECTANGLE:
+    case ShapeType::OVAL:
+      if (header.gradientId != 0)
+        skipRecord(stream);
+      break;
+    default:
+      QXP_DEBUG_MSG(("Unsupported shape\n"));
+      throw GenericException();
+    }
+    break;
+  case ContentType::PICTURE:
+  {
+    if (readahead)
+      readahead->addPicture(header.contentIndex);
+    const bool isBezier = header.shapeType == ShapeType::BEZIER_BOX;
+    switch (header.shapeType)
+    {
+    case ShapeType::BEZIER_BOX:
+    case ShapeType::RECTANGLE:
+    case ShapeType::ROUNDED_RECTANGLE:
+    case ShapeType::CONCAVE_RECTANGLE:
+    case ShapeType::BEVELED_RECTANGLE:
+    case ShapeType::OVAL:
+      break;
+    default:
+      QXP_DEBUG_MSG(("Unsupported shape\n"));
+      throw GenericException();
+    }
+    skip(stream, 104);
+    skipRecord(stream); // OLE object
+    if (header.gradientId != 0)
+      skipRecord(stream);
+    skip(stream, 4);
+    const uint32_t sid = readU32(stream, be);
+    skip(stream, 40);
+    if (isBezier)
+    {
+      skip(stream, 76);
+      skipRecord(stream); // bezier data
+    }
+    else
+    {
+      skip(stream, 52);
+      const uint32_t pid = readU32(stream, be);
+      skip(stream, 20);
+      if (pid != 0)
+        skipRecord(stream); // bezier data
+    }
+    if (header.contentIndex != 0 && sid != 0)
+      skipRecord(stream); // image data
+    break;
+  }
+  case ContentType::TEXT:
+  {
+    if (readahead)
+      readahead->addText(header.contentIndex);
+    LinkedTextSettings linkSettings;
+    skip(stream, 108);
+    switch (header.shapeType)
+    {
+    case ShapeType::LINE:
+    case ShapeType::ORTHOGONAL_LINE:
+      linkSettings.offsetIntoText = readU32(stream, be);
+      skip(stream, 64);
+      skipTextObjectEnd(stream, header, linkSettings);
+      break;
+    case ShapeType::BEZIER_LINE:
+      linkSettings.offsetIntoText = readU32(stream, be);
+      skip(stream, 64);
+      skipRecord(stream); // bezier data
+      skipTextObjectEnd(stream, header, linkSettings);
+      break;
+    case ShapeType::BEZIER_BOX:
+      if (header.gradientId != 0)
+        skipRecord(stream);
+      linkSettings.offsetIntoText = readU32(stream, be);
+      skip(stream, 64);
+      skipRecord(stream); // bezier data
+      skipTextObjectEnd(stream, header, linkSettings);
+      break;
+    case ShapeType::RECTANGLE:
+    case ShapeType::ROUNDED_RECTANGLE:
+    case ShapeType::CONCAVE_RECTANGLE:
+    case ShapeType::BEVELED_RECTANGLE:
+    case ShapeType::OVAL:
+      if (header.gradientId != 0)
+        skipRecord(stream);
+      linkSettings.offsetIntoText = readU32(stream, be);
+      skip(stream, 48);
+      linkSettings.unknownIndex = readU32(stream, be);
+      skip(stream, 12);
+      if (linkSettings.unknownIndex == 0)
+        skipTextObjectEnd(stream, header, linkSettings);
+      break;
+    default:
+      QXP_DEBUG_MSG(("Unsupported shape\n"));
+      throw GenericException();
+    }
+    // later boxes of the story may be on a page that is parsed
+    if (storyCollector && header.contentIndex != 0 && linkSettings.offsetIntoText == 0)
+      parseText(header.contentIndex, header.linkId, *storyCollector);
+    break;
+  }
+  case ContentType::OBJECTS:
+  {
+    skip(stream, 108);
+    const unsigned count = readU16(stream, be);
+    if (count > page.objectsCount - 1)
+    {
+      QXP_DEBUG_MSG(("Invalid group elements count %u\n", count));
+      throw ParseError();
+    }
+    skip(stream, 10 + 4 * count);
+    break;
+  }
+  default:
+    QXP_DEBUG_MSG(("Unsupported content\n"));
+    throw GenericException();
+  }
+
+  deobfuscate.next(uint16_t(header.contentIndex));
+}
+
 QXP4Parser::ObjectHeader QXP4Parser::parseObjectHeader(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXP4Deobfuscator &deobfuscate)
 {
   ObjectHeader result;
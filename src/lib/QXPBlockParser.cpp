@@ -14,6 +14,7 @@
 #include <cassert>
 #include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 #include <iterator>
 
@@ -43,6 +44,14 @@ unsigned long getLength(RVNGInputStream *const input)
 
 }
 
+QXPBlockParser::ChainWalk::ChainWalk(const uint32_t index)
+  : next(index)
+  , isBig(false)
+  , done(false)
+  , visited()
+{
+}
+
 QXPBlockParser::QXPBlockParser(const std::shared_ptr<RVNGInputStream> &input, const std::shared_ptr<QXPHeader> &header)
   : m_input(input)
   , m_header(header)
@@ -50,6 +59,8 @@ QXPBlockParser::QXPBlockParser(const std::shared_ptr<RVNGInputStream> &input, co
   , m_length(getLength(m_input.get()))
   , m_blockLength(256)
   , m_lastBlock(m_length > 0 ? m_length / m_blockLength + 1 : 0)
+  , m_memoryStats(nullptr)
+  , m_parseOptions(nullptr)
 {
 }
 
@@ -61,61 +72,181 @@ std::shared_ptr<RVNGInputStream> QXPBlockParser::getBlock(const uint32_t index)
     unsigned long bytes = 0;
     auto block = m_input->read(m_blockLength, bytes);
     if (bytes > 0)
-      return make_shared<QXPMemoryStream>(block, bytes);
+      return make_shared<QXPMemoryStream>(block, bytes, m_memoryStats);
   }
   return nullptr;
 }
 
-std::shared_ptr<RVNGInputStream> QXPBlockParser::getChain(const uint32_t index)
+unsigned long QXPBlockParser::readBlock(const uint32_t index, unsigned char *const buffer, const unsigned long length)
 {
-  bool bigIdx = m_header->hasBigIndex();
+  if (index > 0 && index <= m_lastBlock)
+  {
+    if (length == 0)
+      return 0;
+    seek(m_input, (index - 1) * m_blockLength);
+    unsigned long bytes = 0;
+    const unsigned char *const block = m_input->read(std::min<unsigned long>(length, m_blockLength), bytes);
+    if (bool(block) && bytes > 0)
+    {
+      std::copy(block, block + bytes, buffer);
+      return bytes;
+    }
+  }
+  QXP_DEBUG_MSG(("Block %u not found\n", index));
+  throw ParseError();
+}
 
+std::shared_ptr<RVNGInputStream> QXPBlockParser::getChain(const uint32_t index)
+{
   vector<unsigned char> chain;
-  bool isBig = false;
-  uint32_t next = index;
+  walkChain(index, &chain, std::numeric_limits<unsigned long>::max());
+  return make_shared<QXPMemoryStream>(std::move(chain), m_memoryStats);
+}
+
+unsigned long QXPBlockParser::getChainLength(const uint32_t index, const unsigned long limit)
+{
+  return walkChain(index, nullptr, limit);
+}
+
+uint32_t QXPBlockParser::blockCount() const
+{
+  return m_lastBlock;
+}
+
+bool QXPBlockParser::nextSegment(ChainWalk &walk, ChainSegment &segment)
+{
+  if (walk.done || walk.next == 0 || walk.next > m_lastBlock)
+  {
+    walk.done = true;
+    return false;
+  }
+
+  const bool bigIdx = m_header->hasBigIndex();
+  bool stop = false;
+  uint32_t len = 0;
   try
   {
-    std::set<uint32_t> visited;
+    checkParseLimits(m_parseOptions);
+    const uint32_t next = walk.next;
+    seek(m_input, (next - 1) * m_blockLength);
+    uint16_t count = walk.isBig ? readU16(m_input, be) : 1;
+    if (count > m_lastBlock - next)
+      count = m_lastBlock - next;
+
+    // Cycle/overlap detection
+    // If this is a big block, we read data up to the previously read
+    // block and only then stop.
+    for (uint32_t i = next - 1; i < next - 1 + count; ++i)
+    {
+      stop = !walk.visited.insert(i).second;
+      if (stop)
+        count = uint16_t(i - next - 1);
+    }
+    if (count == 0)
+    {
+      walk.done = true;
+      return false;
+    }
 
-    while (next > 0 && next <= m_lastBlock)
+    len = (next - 1 + count) * m_blockLength - (bigIdx ? 4 : 2) - m_input->tell();
+    segment.offset = static_cast<unsigned long>(m_input->tell());
+    segment.length = std::min<unsigned long>(len, m_length - std::min<unsigned long>(m_length, segment.offset));
+  }
+  catch (const ParseInterrupted &)
+  {
+    throw;
+  }
+  catch (...)
+  {
+    walk.done = true;
+    return false;
+  }
+
+  if (stop || segment.length < len) // A cycle was detected or we're at the end already
+  {
+    walk.done = true;
+    return true;
+  }
+
+  try
+  {
+    seek(m_input, segment.offset + segment.length);
+    const int32_t nextVal = bigIdx ? readS32(m_input, be) : readS16(m_input, be);
+    walk.isBig = nextVal < 0;
+    walk.next = abs(nextVal);
+  }
+  catch (...)
+  {
+    walk.done = true;
+  }
+  return true;
+}
+
+unsigned long QXPBlockParser::readSegment(const ChainSegment &segment, const unsigned long offset, unsigned char *const buffer, const unsigned long length)
+{
+  if (offset >= segment.length || length == 0)
+    return 0;
+  seek(m_input, segment.offset + offset);
+  unsigned long bytes = 0;
+  const unsigned char *const data = m_input->read(std::min(length, segment.length - offset), bytes);
+  if (bool(data) && bytes > 0)
+    std::copy(data, data + bytes, buffer);
+  return bytes;
+}
+
+unsigned long QXPBlockParser::walkChain(const uint32_t index, std::vector<unsigned char> *const chain, const unsigned long limit)
+{
+  unsigned long length = 0;
+  try
+  {
+    ChainWalk walk(index);
+    ChainSegment segment;
+    while (nextSegment(walk, segment))
     {
-      seek(m_input, (next - 1) * m_blockLength);
-      uint16_t count = isBig ? readU16(m_input, be) : 1;
-      if (count > m_lastBlock - next)
-        count = m_lastBlock - next;
-      bool stop = false;
-
-      // Cycle/overlap detection
-      // If this is a big block, we read data up to the previously read
-      // block and only then stop.
-      for (uint32_t i = next - 1; i < next - 1 + count; ++i)
+      if (chain)
       {
-        stop = !visited.insert(i).second;
-        if (stop)
-          count = uint16_t(i - next - 1);
+        seek(m_input, segment.offset);
+        unsigned long bytes = 0;
+        auto block = m_input->read(segment.length, bytes);
+        if (bool(block) && bytes > 0)
+          std::copy(block, block + bytes, std::back_inserter(*chain));
+        length += bytes;
+        if (bytes < segment.length)
+          break;
       }
-      if (count == 0)
-        break;
-
-      uint32_t len = (next - 1 + count) * m_blockLength - (bigIdx ? 4 : 2) - m_input->tell();
-      unsigned long bytes = 0;
-      auto block = m_input->read(len, bytes);
-      if (bool(block) && bytes > 0)
-        std::copy(block, block + bytes, std::back_inserter(chain));
-
-      if (stop || bytes < len) // A cycle was detected or we're at the end already
+      else
+      {
+        // only the length is needed
+        length += segment.length;
+      }
+      if (length >= limit)
         break;
-
-      const int32_t nextVal = bigIdx ? readS32(m_input, be) : readS16(m_input, be);
-      isBig = nextVal < 0;
-      next = abs(nextVal);
     }
   }
+  catch (const ParseInterrupted &)
+  {
+    throw;
+  }
   catch (...)
   {
     // Just retrieve what's possible
   }
-  return make_shared<QXPMemoryStream>(chain.data(), chain.size());
+  return length;
+}
+
+uint32_t QXPBlockParser::blockLength() const
+{
+  return m_blockLength;
+}
+
+void QXPBlockParser::setMemoryStats(QXPMemoryStats *const memoryStats)
+{
+  m_memoryStats = memoryStats;
+}
+
+void QXPBlockParser::setParseOptions(const QXPParseOptions *const parseOptions)
+{
+  m_parseOptions = parseOptions;
 }
 
 }
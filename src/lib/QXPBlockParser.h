@@ -10,12 +10,18 @@
 #ifndef QXPBLOCKPARSER_H_INCLUDED
 #define QXPBLOCKPARSER_H_INCLUDED
 
+#include <limits>
+#include <set>
+#include <vector>
+
 #include "libqxp_utils.h"
 
 namespace libqxp
 {
 
 class QXPHeader;
+class QXPMemoryStats;
+class QXPParseOptions;
 
 class QXPBlockParser
 {
@@ -24,12 +30,50 @@ class QXPBlockParser
   QXPBlockParser &operator=(const QXPBlockParser &other) = delete;
 
 public:
+  // a run of blocks of a chain, without the links: where its data start in the input and how long they are
+  struct ChainSegment
+  {
+    unsigned long offset;
+    unsigned long length;
+  };
+
+  // how far a chain has been walked
+  struct ChainWalk
+  {
+    explicit ChainWalk(uint32_t index);
+
+    uint32_t next;
+    bool isBig;
+    bool done;
+    std::set<uint32_t> visited;
+  };
+
   QXPBlockParser(const std::shared_ptr<librevenge::RVNGInputStream> &input, const std::shared_ptr<QXPHeader> &header);
 
   std::shared_ptr<librevenge::RVNGInputStream> getBlock(const uint32_t index);
+  // copies at most length bytes of the block into buffer, returns the number of bytes copied
+  unsigned long readBlock(const uint32_t index, unsigned char *buffer, unsigned long length);
   std::shared_ptr<librevenge::RVNGInputStream> getChain(const uint32_t index);
 
+  // returns length of the chain without reading it; stops walking the chain once limit is reached
+  unsigned long getChainLength(const uint32_t index, unsigned long limit = std::numeric_limits<unsigned long>::max());
+  // finds the next run of blocks of the chain and moves walk past it; returns false at the end of the chain
+  bool nextSegment(ChainWalk &walk, ChainSegment &segment);
+  // copies at most length bytes of the segment, starting offset bytes into it, into buffer;
+  // returns the number of bytes copied
+  unsigned long readSegment(const ChainSegment &segment, unsigned long offset, unsigned char *buffer, unsigned long length);
+
+  uint32_t blockLength() const;
+  uint32_t blockCount() const;
+
+  void setMemoryStats(QXPMemoryStats *memoryStats);
+  // limits are checked for every block of a chain
+  void setParseOptions(const QXPParseOptions *parseOptions);
+
 private:
+  // returns length of the chain; its content is appended to chain, if not null
+  unsigned long walkChain(const uint32_t index, std::vector<unsigned char> *chain, unsigned long limit);
+
   const std::shared_ptr<librevenge::RVNGInputStream> m_input;
   const std::shared_ptr<QXPHeader> m_header;
   const bool be; // big endian
@@ -37,6 +81,9 @@ private:
   const unsigned long m_length;
   const uint32_t m_blockLength;
   const uint32_t m_lastBlock;
+
+  QXPMemoryStats *m_memoryStats;
+  const QXPParseOptions *m_parseOptions;
 };
 
 }
@@ -0,0 +1,225 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPChainStream.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <libqxp/QXPMemoryStats.h>
+
+#include "libqxp_utils.h"
+
+namespace libqxp
+{
+
+namespace
+{
+
+// runs of big blocks can be long, so they are read in pieces
+const unsigned long BUFFER_LENGTH = 65536;
+
+}
+
+QXPChainStream::QXPChainStream(QXPBlockParser &blockParser, const uint32_t index, const std::shared_ptr<std::mutex> &inputMutex, QXPMemoryStats *const memoryStats)
+  : m_blockParser(blockParser)
+  , m_inputMutex(inputMutex)
+  , m_memoryStats(memoryStats)
+  , m_walk(index)
+  , m_segments()
+  , m_length(0)
+  , m_pos(0)
+  , m_buffer()
+  , m_bufferStart(0)
+  , m_joined()
+  , m_accounted(0)
+{
+}
+
+QXPChainStream::~QXPChainStream()
+{
+  if (m_memoryStats)
+    m_memoryStats->release(QXPMemoryStats::CATEGORY_STREAMS, m_accounted);
+}
+
+bool QXPChainStream::isStructured()
+{
+  return false;
+}
+
+unsigned QXPChainStream::subStreamCount()
+{
+  return 0;
+}
+
+const char *QXPChainStream::subStreamName(unsigned)
+{
+  return 0;
+}
+
+bool QXPChainStream::existsSubStream(const char *)
+{
+  return false;
+}
+
+librevenge::RVNGInputStream *QXPChainStream::getSubStreamByName(const char *)
+{
+  return 0;
+}
+
+librevenge::RVNGInputStream *QXPChainStream::getSubStreamById(unsigned)
+{
+  return 0;
+}
+
+const unsigned char *QXPChainStream::read(unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+
+  if (numBytes == 0)
+    return 0;
+
+  walkTo(numBytes > std::numeric_limits<unsigned long>::max() - m_pos ? std::numeric_limits<unsigned long>::max() : m_pos + numBytes);
+  if (m_pos >= m_length)
+    return 0;
+  numBytes = std::min(numBytes, m_length - m_pos);
+
+  size_t segment = findSegment(m_pos);
+  const unsigned char *data = 0;
+  if (m_pos + numBytes <= m_segments[segment].start + m_segments[segment].input.length)
+  {
+    data = readSegment(segment, m_pos, numBytes);
+  }
+  else
+  {
+    m_joined.resize(numBytes);
+    for (unsigned long done = 0; done < numBytes; ++segment)
+    {
+      const Segment &current = m_segments[segment];
+      const unsigned long length = std::min(numBytes - done, current.start + current.input.length - (m_pos + done));
+      const unsigned char *const piece = readSegment(segment, m_pos + done, length);
+      std::copy(piece, piece + length, m_joined.begin() + long(done));
+      done += length;
+    }
+    data = m_joined.data();
+  }
+  account();
+
+  m_pos += numBytes;
+  numBytesRead = numBytes;
+  return data;
+}
+catch (const ParseInterrupted &)
+{
+  throw;
+}
+catch (...)
+{
+  return 0;
+}
+
+int QXPChainStream::seek(const long offset, librevenge::RVNG_SEEK_TYPE seekType)
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + long(m_pos);
+    break;
+  case librevenge::RVNG_SEEK_END :
+    walkTo(std::numeric_limits<unsigned long>::max());
+    pos = offset + long(m_length);
+    break;
+  default :
+    return -1;
+  }
+
+  if (pos < 0)
+    return 1;
+  walkTo(static_cast<unsigned long>(pos));
+  if (static_cast<unsigned long>(pos) > m_length)
+    return 1;
+
+  m_pos = static_cast<unsigned long>(pos);
+  return 0;
+}
+
+long QXPChainStream::tell()
+{
+  return long(m_pos);
+}
+
+bool QXPChainStream::isEnd()
+{
+  walkTo(m_pos + 1);
+  return m_pos >= m_length;
+}
+
+void QXPChainStream::walkTo(const unsigned long length)
+{
+  while (m_length < length && !m_walk.done)
+  {
+    Segment segment;
+    bool found = false;
+    {
+      std::lock_guard<std::mutex> lock(*m_inputMutex);
+      found = m_blockParser.nextSegment(m_walk, segment.input);
+    }
+    if (found && segment.input.length > 0)
+    {
+      segment.start = m_length;
+      m_segments.push_back(segment);
+      m_length += segment.input.length;
+    }
+  }
+}
+
+size_t QXPChainStream::findSegment(const unsigned long pos) const
+{
+  const auto it = std::upper_bound(m_segments.begin(), m_segments.end(), pos, [](const unsigned long p, const Segment &segment)
+  {
+    return p < segment.start;
+  });
+  return size_t(it - m_segments.begin()) - 1;
+}
+
+const unsigned char *QXPChainStream::readSegment(const size_t segment, const unsigned long pos, const unsigned long length)
+{
+  if (pos < m_bufferStart || pos + length > m_bufferStart + m_buffer.size())
+  {
+    const Segment &current = m_segments[segment];
+    const unsigned long toRead = std::min(std::max(length, BUFFER_LENGTH), current.start + current.input.length - pos);
+    m_buffer.assign(toRead, 0);
+    m_bufferStart = pos;
+
+    std::lock_guard<std::mutex> lock(*m_inputMutex);
+    m_blockParser.readSegment(current.input, pos - current.start, m_buffer.data(), toRead);
+  }
+  return m_buffer.data() + (pos - m_bufferStart);
+}
+
+void QXPChainStream::account()
+{
+  const unsigned long size = m_buffer.capacity() + m_joined.capacity() + m_segments.capacity() * sizeof(Segment);
+  if (m_memoryStats)
+  {
+    if (size > m_accounted)
+      m_memoryStats->allocate(QXPMemoryStats::CATEGORY_STREAMS, size - m_accounted);
+    else if (size < m_accounted)
+      m_memoryStats->release(QXPMemoryStats::CATEGORY_STREAMS, m_accounted - size);
+  }
+  m_accounted = size;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,92 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPCHAINSTREAM_H_INCLUDED
+#define QXPCHAINSTREAM_H_INCLUDED
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "QXPBlockParser.h"
+
+namespace libqxp
+{
+
+class QXPMemoryStats;
+
+/** A block chain that is read as far as it is needed.
+  *
+  * QXPBlockParser::getChain copies the whole chain at once. This stream
+  * walks the chain only as far as it is read and holds just the part
+  * around the position, plus the places of the runs of blocks found so
+  * far. The input can be read by others, so it is locked for every
+  * access and sought before every read.
+  */
+class QXPChainStream : public librevenge::RVNGInputStream
+{
+// disable copying
+  QXPChainStream(const QXPChainStream &other) = delete;
+  QXPChainStream &operator=(const QXPChainStream &other) = delete;
+
+public:
+  // blockParser must outlive the stream
+  QXPChainStream(QXPBlockParser &blockParser, uint32_t index, const std::shared_ptr<std::mutex> &inputMutex, QXPMemoryStats *memoryStats = nullptr);
+  ~QXPChainStream() override;
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  struct Segment
+  {
+    unsigned long start; // position in the chain
+    QXPBlockParser::ChainSegment input;
+  };
+
+  // walks the chain until it is longer than length or it ends
+  void walkTo(unsigned long length);
+  // returns the segment that contains pos, which must be inside the chain
+  size_t findSegment(unsigned long pos) const;
+  // returns length bytes from pos, which all have to be inside segment
+  const unsigned char *readSegment(size_t segment, unsigned long pos, unsigned long length);
+  // records the change of the size of the buffers
+  void account();
+
+  QXPBlockParser &m_blockParser;
+  const std::shared_ptr<std::mutex> m_inputMutex;
+  QXPMemoryStats *const m_memoryStats;
+  QXPBlockParser::ChainWalk m_walk;
+  std::vector<Segment> m_segments;
+  unsigned long m_length; // of the segments found so far
+  unsigned long m_pos;
+  // part of a segment that has been read last
+  std::vector<unsigned char> m_buffer;
+  unsigned long m_bufferStart;
+  // reads spanning segments are joined here
+  std::vector<unsigned char> m_joined;
+  unsigned long m_accounted;
+};
+
+}
+
+#endif // QXPCHAINSTREAM_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
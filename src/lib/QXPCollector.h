@@ -10,12 +10,17 @@
 #ifndef QXPCOLLECTOR_H_INCLUDED
 #define QXPCOLLECTOR_H_INCLUDED
 
+#include <future>
+#include <map>
+#include <memory>
+
 #include "libqxp_utils.h"
 
 namespace libqxp
 {
 
 struct Box;
+struct Color;
 struct Group;
 struct Line;
 struct Page;
@@ -23,8 +28,22 @@ struct PictureBox;
 struct QXPDocumentProperties;
 struct Text;
 struct TextBox;
+struct TextFormats;
 struct TextPath;
 
+// story that may still be decoded in the background
+typedef std::shared_future<std::shared_ptr<Text>> TextFuture;
+// picture that may still be loaded in the background; empty if it could not be read
+typedef std::shared_future<librevenge::RVNGBinaryData> PictureFuture;
+
+// how much of a picture or text a collector needs; nothing more is read
+enum class ContentNeeds
+{
+  NONE,
+  SIZE,
+  FULL
+};
+
 class QXPCollector
 {
   // disable copying
@@ -35,29 +54,75 @@ public:
   QXPCollector() = default;
   virtual ~QXPCollector() = default;
 
+  virtual ContentNeeds pictureNeeds() const
+  {
+    return ContentNeeds::FULL;
+  }
+
+  virtual ContentNeeds textNeeds() const
+  {
+    return ContentNeeds::FULL;
+  }
+
+  // whether the normal page with the given index is collected; other pages are skipped
+  virtual bool isPageNeeded(unsigned) const
+  {
+    return true;
+  }
+
   virtual void startDocument() { }
   virtual void endDocument() { }
+  // the parse stopped early, so the document is left as it is
+  virtual void abortDocument() { }
 
   virtual void startPage(const Page &) { }
   virtual void endPage() { }
 
   virtual void collectDocumentProperties(const QXPDocumentProperties &) { }
+  virtual void collectColors(const std::map<unsigned, Color> &) { }
+  virtual void collectTextFormats(const TextFormats &) { }
 
   virtual void collectLine(const std::shared_ptr<Line> &) { }
   virtual void collectBox(const std::shared_ptr<Box> &) { }
   virtual void collectPicture(unsigned, librevenge::RVNGBinaryData const &) {}
+  // the picture is still being loaded; collectors that can wait for it until drawing should override this
+  virtual void collectPendingPicture(const unsigned index, const PictureFuture &picture)
+  {
+    const librevenge::RVNGBinaryData &data = picture.get();
+    if (!data.empty())
+      collectPicture(index, data);
+  }
   virtual void collectPictureBox(const std::shared_ptr<PictureBox> &) { }
   virtual void collectTextBox(const std::shared_ptr<TextBox> &) { }
   virtual void collectTextPath(const std::shared_ptr<TextPath> &) { }
   virtual void collectGroup(const std::shared_ptr<Group> &) { }
 
   virtual void collectText(const std::shared_ptr<Text> &, const unsigned) { }
+  // the text is still being decoded; collectors that can wait for it until drawing should override this
+  virtual void collectPendingText(const TextFuture &text, const unsigned linkId)
+  {
+    collectText(text.get(), linkId);
+  }
+
+  virtual void collectPictureSize(unsigned, unsigned long) { }
+  // the text has its formats, but not the characters
+  virtual void collectTextLength(const std::shared_ptr<Text> &, unsigned, unsigned long) { }
 };
 
 class QXPDummyCollector : public QXPCollector
 {
 public:
   QXPDummyCollector() = default;
+
+  ContentNeeds pictureNeeds() const override
+  {
+    return ContentNeeds::NONE;
+  }
+
+  ContentNeeds textNeeds() const override
+  {
+    return ContentNeeds::NONE;
+  }
 };
 
 }
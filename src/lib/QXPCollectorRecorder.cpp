@@ -0,0 +1,201 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPCollectorRecorder.h"
+
+namespace libqxp
+{
+
+using std::shared_ptr;
+using std::static_pointer_cast;
+
+QXPCollectorRecorder::Call::Call(const Type type_)
+  : type(type_)
+  , page()
+  , object()
+  , text()
+  , pendingText()
+  , picture()
+  , pendingPicture()
+  , index(0)
+  , size(0)
+{
+}
+
+QXPCollectorRecorder::QXPCollectorRecorder(const QXPCollector &target)
+  : m_target(target)
+  , m_calls()
+{
+}
+
+void QXPCollectorRecorder::replay(QXPCollector &collector) const
+{
+  for (const auto &call : m_calls)
+  {
+    switch (call.type)
+    {
+    case Call::START_PAGE:
+      collector.startPage(call.page);
+      break;
+    case Call::END_PAGE:
+      collector.endPage();
+      break;
+    case Call::COLLECT_LINE:
+      collector.collectLine(static_pointer_cast<Line>(call.object));
+      break;
+    case Call::COLLECT_BOX:
+      collector.collectBox(static_pointer_cast<Box>(call.object));
+      break;
+    case Call::COLLECT_PICTURE:
+      collector.collectPicture(call.index, call.picture);
+      break;
+    case Call::COLLECT_PENDING_PICTURE:
+      collector.collectPendingPicture(call.index, call.pendingPicture);
+      break;
+    case Call::COLLECT_PICTURE_BOX:
+      collector.collectPictureBox(static_pointer_cast<PictureBox>(call.object));
+      break;
+    case Call::COLLECT_TEXT_BOX:
+      collector.collectTextBox(static_pointer_cast<TextBox>(call.object));
+      break;
+    case Call::COLLECT_TEXT_PATH:
+      collector.collectTextPath(static_pointer_cast<TextPath>(call.object));
+      break;
+    case Call::COLLECT_GROUP:
+      collector.collectGroup(static_pointer_cast<Group>(call.object));
+      break;
+    case Call::COLLECT_TEXT:
+      collector.collectText(call.text, call.index);
+      break;
+    case Call::COLLECT_PENDING_TEXT:
+      collector.collectPendingText(call.pendingText, call.index);
+      break;
+    case Call::COLLECT_PICTURE_SIZE:
+      collector.collectPictureSize(call.index, call.size);
+      break;
+    case Call::COLLECT_TEXT_LENGTH:
+      collector.collectTextLength(call.text, call.index, call.size);
+      break;
+    }
+  }
+}
+
+void QXPCollectorRecorder::clear()
+{
+  m_calls.clear();
+}
+
+ContentNeeds QXPCollectorRecorder::pictureNeeds() const
+{
+  return m_target.pictureNeeds();
+}
+
+ContentNeeds QXPCollectorRecorder::textNeeds() const
+{
+  return m_target.textNeeds();
+}
+
+bool QXPCollectorRecorder::isPageNeeded(const unsigned index) const
+{
+  return m_target.isPageNeeded(index);
+}
+
+void QXPCollectorRecorder::startPage(const Page &page)
+{
+  m_calls.push_back(Call(Call::START_PAGE));
+  m_calls.back().page = page;
+}
+
+void QXPCollectorRecorder::endPage()
+{
+  m_calls.push_back(Call(Call::END_PAGE));
+}
+
+void QXPCollectorRecorder::collectLine(const shared_ptr<Line> &line)
+{
+  m_calls.push_back(Call(Call::COLLECT_LINE));
+  m_calls.back().object = line;
+}
+
+void QXPCollectorRecorder::collectBox(const shared_ptr<Box> &box)
+{
+  m_calls.push_back(Call(Call::COLLECT_BOX));
+  m_calls.back().object = box;
+}
+
+void QXPCollectorRecorder::collectPicture(const unsigned index, librevenge::RVNGBinaryData const &picture)
+{
+  m_calls.push_back(Call(Call::COLLECT_PICTURE));
+  m_calls.back().index = index;
+  m_calls.back().picture = picture;
+}
+
+void QXPCollectorRecorder::collectPendingPicture(const unsigned index, const PictureFuture &picture)
+{
+  m_calls.push_back(Call(Call::COLLECT_PENDING_PICTURE));
+  m_calls.back().index = index;
+  m_calls.back().pendingPicture = picture;
+}
+
+void QXPCollectorRecorder::collectPictureBox(const shared_ptr<PictureBox> &box)
+{
+  m_calls.push_back(Call(Call::COLLECT_PICTURE_BOX));
+  m_calls.back().object = box;
+}
+
+void QXPCollectorRecorder::collectTextBox(const shared_ptr<TextBox> &textbox)
+{
+  m_calls.push_back(Call(Call::COLLECT_TEXT_BOX));
+  m_calls.back().object = textbox;
+}
+
+void QXPCollectorRecorder::collectTextPath(const shared_ptr<TextPath> &textPath)
+{
+  m_calls.push_back(Call(Call::COLLECT_TEXT_PATH));
+  m_calls.back().object = textPath;
+}
+
+void QXPCollectorRecorder::collectGroup(const shared_ptr<Group> &group)
+{
+  m_calls.push_back(Call(Call::COLLECT_GROUP));
+  m_calls.back().object = group;
+}
+
+void QXPCollectorRecorder::collectText(const shared_ptr<Text> &text, const unsigned linkId)
+{
+  m_calls.push_back(Call(Call::COLLECT_TEXT));
+  m_calls.back().text = text;
+  m_calls.back().index = linkId;
+}
+
+void QXPCollectorRecorder::collectPendingText(const TextFuture &text, const unsigned linkId)
+{
+  m_calls.push_back(Call(Call::COLLECT_PENDING_TEXT));
+  m_calls.back().pendingText = text;
+  m_calls.back().index = linkId;
+}
+
+void QXPCollectorRecorder::collectPictureSize(const unsigned index, const unsigned long size)
+{
+  m_calls.push_back(Call(Call::COLLECT_PICTURE_SIZE));
+  m_calls.back().index = index;
+  m_calls.back().size = size;
+}
+
+void QXPCollectorRecorder::collectTextLength(const std::shared_ptr<Text> &runs, const unsigned linkId, const unsigned long length)
+{
+  m_calls.push_back(Call(Call::COLLECT_TEXT_LENGTH));
+  m_calls.back().text = runs;
+  m_calls.back().index = linkId;
+  m_calls.back().size = length;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,106 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPCOLLECTORRECORDER_H_INCLUDED
+#define QXPCOLLECTORRECORDER_H_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "QXPCollector.h"
+#include "QXPTypes.h"
+
+namespace libqxp
+{
+
+/** Collector that records the calls made while parsing pages, to be
+  * replayed later.
+  *
+  * This allows to parse several pages concurrently, while still passing
+  * them on to the real collector in page order. What content is needed
+  * is decided by the real collector, which must answer that from any
+  * thread. Calls concerning the whole document are not expected and
+  * are not recorded.
+  */
+class QXPCollectorRecorder : public QXPCollector
+{
+public:
+  explicit QXPCollectorRecorder(const QXPCollector &target);
+
+  /// Passes the recorded calls on to @c collector.
+  void replay(QXPCollector &collector) const;
+
+  /// Drops all recorded calls.
+  void clear();
+
+  ContentNeeds pictureNeeds() const override;
+  ContentNeeds textNeeds() const override;
+  bool isPageNeeded(unsigned index) const override;
+
+  void startPage(const Page &page) override;
+  void endPage() override;
+
+  void collectLine(const std::shared_ptr<Line> &line) override;
+  void collectBox(const std::shared_ptr<Box> &box) override;
+  void collectPicture(unsigned index, librevenge::RVNGBinaryData const &picture) override;
+  void collectPendingPicture(unsigned index, const PictureFuture &picture) override;
+  void collectPictureBox(const std::shared_ptr<PictureBox> &box) override;
+  void collectTextBox(const std::shared_ptr<TextBox> &textbox) override;
+  void collectTextPath(const std::shared_ptr<TextPath> &textPath) override;
+  void collectGroup(const std::shared_ptr<Group> &group) override;
+
+  void collectText(const std::shared_ptr<Text> &text, unsigned linkId) override;
+  void collectPendingText(const TextFuture &text, unsigned linkId) override;
+
+  void collectPictureSize(unsigned index, unsigned long size) override;
+  void collectTextLength(const std::shared_ptr<Text> &runs, unsigned linkId, unsigned long length) override;
+
+private:
+  struct Call
+  {
+    enum Type
+    {
+      START_PAGE,
+      END_PAGE,
+      COLLECT_LINE,
+      COLLECT_BOX,
+      COLLECT_PICTURE,
+      COLLECT_PENDING_PICTURE,
+      COLLECT_PICTURE_BOX,
+      COLLECT_TEXT_BOX,
+      COLLECT_TEXT_PATH,
+      COLLECT_GROUP,
+      COLLECT_TEXT,
+      COLLECT_PENDING_TEXT,
+      COLLECT_PICTURE_SIZE,
+      COLLECT_TEXT_LENGTH
+    };
+
+    explicit Call(Type type_);
+
+    Type type;
+    Page page;
+    std::shared_ptr<Object> object;
+    std::shared_ptr<Text> text;
+    TextFuture pendingText;
+    librevenge::RVNGBinaryData picture;
+    PictureFuture pendingPicture;
+    unsigned index;
+    unsigned long size;
+  };
+
+  const QXPCollector &m_target;
+  std::vector<Call> m_calls;
+};
+
+}
+
+#endif // QXPCOLLECTORRECORDER_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,12 +10,16 @@
 #include "QXPContentCollector.h"
 
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <utility>
 #include <iterator>
 
 #include <boost/range/adaptor/reversed.hpp>
 #include <boost/variant.hpp>
 
+#include <libqxp/QXPMemoryStats.h>
+
 namespace libqxp
 {
 
@@ -160,68 +164,6 @@ void writeZIndex(librevenge::RVNGPropertyList &propList, unsigned value)
   propList.insert("draw:z-index", static_cast<int>(value));
 }
 
-void flushText(librevenge::RVNGDrawingInterface *painter, string &text)
-{
-  if (!text.empty())
-  {
-    painter->insertText(RVNGString(text.c_str()));
-    text.clear();
-  }
-}
-
-void insertText(librevenge::RVNGDrawingInterface *painter, const RVNGString &text)
-{
-  // TODO: need to remember wasSpace on span change?
-  bool wasSpace = false;
-  std::string curText;
-
-  RVNGString::Iter iter(text);
-  iter.rewind();
-  while (iter.next())
-  {
-    const char *const utf8Char = iter();
-    switch (utf8Char[0])
-    {
-    case '\r':
-      wasSpace = false;
-      break;
-    case '\n':
-      wasSpace = false;
-      flushText(painter, curText);
-      painter->insertLineBreak();
-      break;
-    case '\t':
-      wasSpace = false;
-      flushText(painter, curText);
-      painter->insertTab();
-      break;
-    case ' ':
-      if (wasSpace)
-      {
-        flushText(painter, curText);
-        painter->insertSpace();
-      }
-      else
-      {
-        wasSpace = true;
-        curText.push_back(' ');
-      }
-      break;
-    default:
-      wasSpace = false;
-      if (utf8Char[0]>=0 && utf8Char[0]<=0x1f)
-      {
-        QXP_DEBUG_MSG(("insertText[QPXContentCollector.cpp]: bad character=%x\n",unsigned(utf8Char[0])));
-        break;
-      }
-      curText.append(utf8Char);
-      break;
-    }
-  }
-
-  flushText(painter, curText);
-}
-
 void writeArrow(RVNGPropertyList &propList, const char *const name, const Arrow &arrow, double width)
 {
   librevenge::RVNGString propName;
@@ -290,10 +232,33 @@ void writeTextPosition(RVNGPropertyList &propList, const double offset, const do
   propList.insert("style:text-position", pos);
 }
 
+unsigned long getMemorySize(const std::shared_ptr<Text> &text)
+{
+  if (!text)
+    return 0;
+  return sizeof(Text) + text->text.capacity()
+         + text->paragraphs.formatIndexes.capacity() * 3 * sizeof(uint32_t)
+         + text->charFormats.formatIndexes.capacity() * 3 * sizeof(uint32_t);
+}
+
+unsigned long getMemorySize(const librevenge::RVNGBinaryData &data)
+{
+  return data.size();
+}
+
+template<typename T>
+std::shared_future<T> makeReady(const T &value)
+{
+  std::promise<T> promise;
+  promise.set_value(value);
+  return promise.get_future().share();
 }
 
-QXPContentCollector::QXPContentCollector(librevenge::RVNGDrawingInterface *painter)
+}
+
+QXPContentCollector::QXPContentCollector(librevenge::RVNGDrawingInterface *painter, QXPMemoryStats *const memoryStats)
   : m_painter(painter)
+  , m_memoryStats(memoryStats)
   , m_isDocumentStarted(false)
   , m_isCollectingFacingPage(false)
   , m_currentObjectIndex(0)
@@ -302,6 +267,8 @@ QXPContentCollector::QXPContentCollector(librevenge::RVNGDrawingInterface *paint
   , m_linkTextMap()
   , m_linkIndexedTextObjectsMap()
   , m_docProps()
+  , m_paragraphPropListCache()
+  , m_spanPropListCache()
 {
 }
 
@@ -311,6 +278,14 @@ QXPContentCollector::~QXPContentCollector()
   {
     endDocument();
   }
+
+  if (m_memoryStats)
+  {
+    for (const auto &indexPicture : m_indexPictureDataMap)
+      m_memoryStats->release(QXPMemoryStats::CATEGORY_PICTURES, indexPicture.second.memorySize);
+    for (const auto &linkText : m_linkTextMap)
+      m_memoryStats->release(QXPMemoryStats::CATEGORY_TEXTS, linkText.second.memorySize);
+  }
 }
 
 void QXPContentCollector::startDocument()
@@ -339,6 +314,18 @@ void QXPContentCollector::endDocument()
   m_isDocumentStarted = false;
 }
 
+void QXPContentCollector::abortDocument()
+{
+  if (m_memoryStats)
+  {
+    for (const auto &page : m_unprocessedPages)
+      m_memoryStats->release(QXPMemoryStats::CATEGORY_PAGES, page.memorySize);
+  }
+  // the held-back pages may wait for content that is never parsed
+  m_unprocessedPages.clear();
+  m_isDocumentStarted = false;
+}
+
 void QXPContentCollector::startPage(const Page &page)
 {
   m_unprocessedPages.push_back(CollectedPage(page.pageSettings[0]));
@@ -359,74 +346,76 @@ void QXPContentCollector::endPage()
 void QXPContentCollector::collectDocumentProperties(const QXPDocumentProperties &props)
 {
   m_docProps = props;
+  // cached property lists depend on document settings
+  m_spanPropListCache.clear();
+  m_paragraphPropListCache.clear();
 }
 
 void QXPContentCollector::collectLine(const std::shared_ptr<Line> &line)
 {
-  addObject<Line>(line, &QXPContentCollector::drawLine);
+  addObject<Line>(line, CollectedObjectType::LINE);
 }
 
 void QXPContentCollector::collectBox(const std::shared_ptr<Box> &box)
 {
-  addObject<Box>(box, &QXPContentCollector::drawBox);
+  addObject<Box>(box, CollectedObjectType::BOX);
 }
 
 void QXPContentCollector::collectPictureBox(const std::shared_ptr<PictureBox> &box)
 {
-  addObject<PictureBox>(box, &QXPContentCollector::drawPictureBox);
+  addObject<PictureBox>(box, CollectedObjectType::PICTURE_BOX);
 }
 
 void QXPContentCollector::collectPicture(unsigned index, librevenge::RVNGBinaryData const &pict)
 {
-  m_indexPictureDataMap[index] = pict;
+  setContent(m_indexPictureDataMap[index], makeReady(pict), QXPMemoryStats::CATEGORY_PICTURES);
+}
+
+void QXPContentCollector::collectPendingPicture(const unsigned index, const PictureFuture &picture)
+{
+  setContent(m_indexPictureDataMap[index], picture, QXPMemoryStats::CATEGORY_PICTURES);
 }
 
 void QXPContentCollector::collectTextBox(const std::shared_ptr<TextBox> &textbox)
 {
-  addObject<TextBox>(textbox, &QXPContentCollector::drawTextBox);
+  auto &page = addObject<TextBox>(textbox, CollectedObjectType::TEXT_BOX);
 
   if (0 == textbox->linkSettings.linkId)
   {
     QXP_DEBUG_MSG(("Collected textbox with link ID 0"));
   }
 
-  collectTextObject(textbox, getInsertionPage(textbox));
+  collectTextObject(textbox, page);
 }
 
 void QXPContentCollector::collectTextPath(const std::shared_ptr<TextPath> &textPath)
 {
-  addObject<TextPath>(textPath, &QXPContentCollector::drawTextPath);
+  auto &page = addObject<TextPath>(textPath, CollectedObjectType::TEXT_PATH);
 
   if (0 == textPath->linkSettings.linkId)
   {
     QXP_DEBUG_MSG(("Collected text path with link ID 0"));
   }
 
-  collectTextObject(textPath, getInsertionPage(textPath));
+  collectTextObject(textPath, page);
 }
 
 void QXPContentCollector::collectGroup(const std::shared_ptr<Group> &group)
 {
-  auto collectedObj = addObject<Group>(group, &QXPContentCollector::drawGroup);
+  const unsigned index = m_currentObjectIndex;
+  auto &page = addObject<Group>(group, CollectedObjectType::GROUP);
 
-  getInsertionPage(group).groups.push_back(collectedObj);
+  page.groups.push_back(index);
 }
 
 void QXPContentCollector::collectText(const std::shared_ptr<Text> &text, const unsigned linkId)
 {
-  m_linkTextMap[linkId] = text;
+  setContent(m_linkTextMap[linkId], makeReady(text), QXPMemoryStats::CATEGORY_TEXTS);
+}
 
-  auto it = m_linkIndexedTextObjectsMap.find(linkId);
-  if (it != m_linkIndexedTextObjectsMap.end())
-  {
-    for (const auto &indexTextbox : it->second)
-    {
-      if (!indexTextbox.second->text)
-      {
-        indexTextbox.second->text = text;
-      }
-    }
-  }
+void QXPContentCollector::collectPendingText(const TextFuture &text, const unsigned linkId)
+{
+  setContent(m_linkTextMap[linkId], text, QXPMemoryStats::CATEGORY_TEXTS);
 }
 
 QXPContentCollector::CollectedPage &QXPContentCollector::getInsertionPage(const std::shared_ptr<Object> &obj)
@@ -462,8 +451,10 @@ void QXPContentCollector::draw(bool force)
       unsigned i = 0;
       for (auto &obj : boost::adaptors::reverse(page.objects))
       {
-        if (!obj.second->zIndex())
-          obj.second->setZIndex(i);
+        if (!obj.object)
+          continue;
+        if (!obj.object->zIndex)
+          obj.object->zIndex = i;
         // we can't just increment by 1 because some objects may need to create several elements (such as box + text)
         // also we can't just have a counter instead of this field because groups may not be consecutive
         i += 100;
@@ -472,22 +463,105 @@ void QXPContentCollector::draw(bool force)
 
     // handle groups first
     // afaik groups that are part of other group never go before that group
-    for (const auto &group : page.groups)
+    for (const unsigned group : page.groups)
     {
-      group->draw(page);
+      drawObject(page.objects[group], page);
     }
 
     for (auto &obj : page.objects)
     {
-      obj.second->draw(page);
+      drawObject(obj, page);
     }
 
     m_painter->endPage();
+
+    if (m_memoryStats)
+      m_memoryStats->release(QXPMemoryStats::CATEGORY_PAGES, page.memorySize);
   }
 
   m_unprocessedPages.clear();
 }
 
+void QXPContentCollector::drawObject(CollectedObject &obj, CollectedPage &page)
+{
+  if (obj.isProcessed)
+    return;
+  obj.isProcessed = true;
+
+  switch (obj.type)
+  {
+  case CollectedObjectType::LINE:
+    drawLine(obj.get<Line>(), page);
+    break;
+  case CollectedObjectType::BOX:
+    drawBox(obj.get<Box>(), page);
+    break;
+  case CollectedObjectType::PICTURE_BOX:
+    drawPictureBox(obj.get<PictureBox>(), page);
+    break;
+  case CollectedObjectType::TEXT_BOX:
+    drawTextBox(obj.get<TextBox>(), page);
+    break;
+  case CollectedObjectType::TEXT_PATH:
+    drawTextPath(obj.get<TextPath>(), page);
+    break;
+  case CollectedObjectType::GROUP:
+    drawGroup(obj.get<Group>(), page);
+    break;
+  case CollectedObjectType::NONE:
+    break;
+  }
+}
+
+void QXPContentCollector::addPageMemory(CollectedPage &page, const unsigned long size)
+{
+  page.memorySize += size;
+  if (m_memoryStats)
+    m_memoryStats->allocate(QXPMemoryStats::CATEGORY_PAGES, size);
+}
+
+template<typename T>
+void QXPContentCollector::setContent(PendingContent<T> &content, const std::shared_future<T> &value, const QXPMemoryStats::Category category)
+{
+  if (m_memoryStats)
+    m_memoryStats->release(category, content.memorySize);
+  content = PendingContent<T>();
+  content.value = value;
+  // loaded content is accounted right away, so the peak is the same as without background loading
+  if (value.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+    getContent(content, category);
+}
+
+template<typename T>
+const T &QXPContentCollector::getContent(PendingContent<T> &content, const QXPMemoryStats::Category category)
+{
+  const T &value = content.value.get();
+  if (!content.isAccounted)
+  {
+    content.isAccounted = true;
+    content.memorySize = getMemorySize(value);
+    if (m_memoryStats)
+      m_memoryStats->allocate(category, content.memorySize);
+  }
+  return value;
+}
+
+bool QXPContentCollector::resolveText(TextObject &textObj)
+{
+  if (!textObj.text)
+  {
+    auto textIt = m_linkTextMap.find(textObj.linkSettings.linkId);
+    if (textIt != m_linkTextMap.end())
+      textObj.text = getContent(textIt->second, QXPMemoryStats::CATEGORY_TEXTS);
+  }
+  return bool(textObj.text);
+}
+
+bool QXPContentCollector::hasText(const TextObject &textObj) const
+{
+  return textObj.text || m_linkTextMap.find(textObj.linkSettings.linkId) != m_linkTextMap.end();
+}
+
 void QXPContentCollector::collectTextObject(const std::shared_ptr<TextObject> &textObj, CollectedPage &page)
 {
   if (textObj->linkSettings.linkedIndex > 0)
@@ -498,15 +572,7 @@ void QXPContentCollector::collectTextObject(const std::shared_ptr<TextObject> &t
   if (textObj->isLinked())
   {
     page.linkedTextObjects.push_back(textObj);
-  }
-
-  if (!textObj->text)
-  {
-    auto textIt = m_linkTextMap.find(textObj->linkSettings.linkId);
-    if (textIt != m_linkTextMap.end())
-    {
-      textObj->text = textIt->second;
-    }
+    addPageMemory(page, sizeof(textObj));
   }
 }
 
@@ -539,7 +605,7 @@ bool QXPContentCollector::hasUnfinishedLinkedTexts()
   {
     for (const auto &textObj : page.linkedTextObjects)
     {
-      if (!textObj->text || (textObj->linkSettings.nextLinkedIndex > 0 && !textObj->linkSettings.textLength))
+      if (!hasText(*textObj) || (textObj->linkSettings.nextLinkedIndex > 0 && !textObj->linkSettings.textLength))
       {
         return true;
       }
@@ -616,9 +682,14 @@ void QXPContentCollector::drawPictureBox(const std::shared_ptr<PictureBox> &box,
   drawBox(box, page);
   if (box->contentIndex)
   {
-    auto const &it=m_indexPictureDataMap.find(box->contentIndex);
+    auto it=m_indexPictureDataMap.find(box->contentIndex);
     if (it!=m_indexPictureDataMap.end())
     {
+      const librevenge::RVNGBinaryData &data = getContent(it->second, QXPMemoryStats::CATEGORY_PICTURES);
+      // pictures that failed to load in the background are empty
+      if (data.empty())
+        return;
+
       librevenge::RVNGPropertyList propList;
       writeFill(propList, box->fill);
       writeFrame(propList, box->frame, box->runaround);
@@ -632,7 +703,7 @@ void QXPContentCollector::drawPictureBox(const std::shared_ptr<PictureBox> &box,
       propList.insert("svg:height", double(bbox.height()), librevenge::RVNG_POINT);
 
       propList.insert("librevenge:mime-type", "image/pict");
-      propList.insert("office:binary-data", it->second);
+      propList.insert("office:binary-data", data);
       writeZIndex(propList, box->zIndex+1);
       m_painter->drawGraphicObject(propList);
     }
@@ -800,7 +871,7 @@ void QXPContentCollector::drawTextBox(const std::shared_ptr<TextBox> &textbox, c
 
   m_painter->startTextObject(textObjPropList);
 
-  if (textbox->text)
+  if (resolveText(*textbox))
   {
     drawText(textbox->text.get(), textbox->linkSettings);
   }
@@ -812,7 +883,7 @@ void QXPContentCollector::drawTextPath(const std::shared_ptr<TextPath> &textPath
 {
   drawLine(textPath, page);
 
-  if (!textPath->text)
+  if (!resolveText(*textPath))
   {
     return;
   }
@@ -884,117 +955,42 @@ void QXPContentCollector::drawText(const std::shared_ptr<Text> &text, const Link
 
   unsigned paragraphInd = 0;
 
-  for (auto &paragraph : text->paragraphs)
+  for (unsigned i = 0; i < text->paragraphs.size(); ++i)
   {
-    if (paragraph.startIndex >= textEnd)
+    const auto &paragraphs = text->paragraphs;
+    if (paragraphs.startIndex(i) >= textEnd)
     {
       break;
     }
-    if (spanTextStart > paragraph.endIndex())
+    if (spanTextStart > paragraphs.endIndex(i))
     {
       continue;
     }
 
-    librevenge::RVNGPropertyList paragraphPropList;
-
-    paragraphPropList.insert("fo:margin-top", paragraph.format->margin.top, RVNG_POINT);
-    paragraphPropList.insert("fo:margin-right", paragraph.format->margin.right, RVNG_POINT);
-    paragraphPropList.insert("fo:margin-bottom", paragraph.format->margin.bottom, RVNG_POINT);
-    paragraphPropList.insert("fo:margin-left", paragraph.format->margin.left, RVNG_POINT);
-
-    paragraphPropList.insert("fo:text-indent", paragraph.format->firstLineIndent, RVNG_POINT);
-
-    if (!QXP_ALMOST_ZERO(paragraph.format->leading) && !paragraph.format->incrementalLeading)
+    const auto &paragraphFormat = text->paragraphFormat(i);
+    double lineHeight = paragraphFormat.leading;
+    if (QXP_ALMOST_ZERO(paragraphFormat.leading) || paragraphFormat.incrementalLeading)
     {
-      paragraphPropList.insert("fo:line-height", paragraph.format->leading, RVNG_POINT);
-    }
-    else
-    {
-      const double fontSize = text->maxFontSize(paragraph);
+      const double fontSize = text->maxFontSize(i);
       const double initialLeading = fontSize + (m_docProps.isIncrementalAutoLeading() ? m_docProps.autoLeading() : (fontSize * m_docProps.autoLeading()));
-      const double lineHeight = initialLeading + paragraph.format->leading;
-      paragraphPropList.insert("fo:line-height", lineHeight, RVNG_POINT);
+      lineHeight = initialLeading + paragraphFormat.leading;
     }
 
-    switch (paragraph.format->alignment)
-    {
-    case HorizontalAlignment::LEFT:
-      paragraphPropList.insert("fo:text-align", "left");
-      break;
-    case HorizontalAlignment::RIGHT:
-      paragraphPropList.insert("fo:text-align", "end");
-      break;
-    case HorizontalAlignment::CENTER:
-      paragraphPropList.insert("fo:text-align", "center");
-      break;
-    case HorizontalAlignment::JUSTIFIED:
-    case HorizontalAlignment::FORCED:
-      paragraphPropList.insert("fo:text-align", "justify");
-      break;
-    }
-    paragraphPropList.insert("fo:text-align-last", "start");
+    const bool borderTop = paragraphFormat.ruleAbove && paragraphInd > 0;
+    const bool borderBottom = paragraphFormat.ruleBelow && paragraphInd < paragraphs.size() - 1;
 
-    if (paragraph.format->hj)
-    {
-      paragraphPropList.insert("fo:hyphenate", paragraph.format->hj->hyphenate);
-      if (paragraph.format->hj->maxInRow == 0)
-        paragraphPropList.insert("fo:hyphenation-ladder-count", "no-limit");
-      else
-        paragraphPropList.insert("fo:hyphenation-ladder-count", int(paragraph.format->hj->maxInRow));
-      paragraphPropList.insert("style:justify-single-word", paragraph.format->hj->singleWordJustify);
-    }
+    m_painter->openParagraph(getParagraphPropList(*text, i, lineHeight, borderTop, borderBottom));
 
-    if (!paragraph.format->tabStops.empty())
+    const auto &charFormats = text->charFormats;
+    const size_t charFormatsBegin = i < text->paragraphMetrics.size() ? text->paragraphMetrics[i].firstCharFormat : 0;
+    for (size_t j = charFormatsBegin; j < charFormats.size(); ++j)
     {
-      RVNGPropertyListVector tabs;
-      for (const auto &tab : paragraph.format->tabStops)
-      {
-        RVNGPropertyList tabProps;
-        tabProps.insert("style:position", tab.position, RVNG_POINT);
-        if (!tab.fillChar.empty())
-        {
-          tabProps.insert("style:leader-text", tab.fillChar);
-        }
-        switch (tab.type)
-        {
-        case TabStopType::LEFT:
-          tabProps.insert("style:type", "left");
-          break;
-        case TabStopType::RIGHT:
-          tabProps.insert("style:type", "right");
-          break;
-        case TabStopType::CENTER:
-          tabProps.insert("style:type", "center");
-          break;
-        case TabStopType::ALIGN:
-          tabProps.insert("style:type", "char");
-          tabProps.insert("style:char", tab.alignChar);
-          break;
-        }
-        tabs.append(tabProps);
-      }
-      paragraphPropList.insert("librevenge:tab-stops", tabs);
-    }
-
-    if (paragraph.format->ruleAbove && paragraphInd > 0)
-    {
-      writeBorder(paragraphPropList, "fo:border-top", paragraph.format->ruleAbove);
-    }
-    if (paragraph.format->ruleBelow && paragraphInd < text->paragraphs.size() - 1)
-    {
-      writeBorder(paragraphPropList, "fo:border-bottom", paragraph.format->ruleBelow);
-    }
-
-    m_painter->openParagraph(paragraphPropList);
-
-    for (auto &charFormat : text->charFormats)
-    {
-      if (spanTextStart > paragraph.endIndex() || spanTextStart >= textEnd || charFormat.startIndex > paragraph.endIndex() || charFormat.startIndex >= textEnd)
+      if (spanTextStart > paragraphs.endIndex(i) || spanTextStart >= textEnd || charFormats.startIndex(j) > paragraphs.endIndex(i) || charFormats.startIndex(j) >= textEnd)
       {
         break;
       }
 
-      if (spanTextStart > charFormat.endIndex())
+      if (spanTextStart > charFormats.endIndex(j))
       {
         continue;
       }
@@ -1006,85 +1002,17 @@ void QXPContentCollector::drawText(const std::shared_ptr<Text> &text, const Link
       }
 
       const auto spanTextEnd = static_cast<unsigned long>(
-                                 std::min<uint64_t>({ charFormat.afterEndIndex(), paragraph.afterEndIndex(), text->text.length(), textEnd })
+                                 std::min<uint64_t>({ charFormats.afterEndIndex(j), paragraphs.afterEndIndex(i), text->text.length(), textEnd })
                                );
 
-      if (charFormat.format->isControlChars)
+      const auto &charFormat = text->charFormat(j);
+      if (charFormat.isControlChars)
       {
         spanTextStart = spanTextEnd;
         continue;
       }
 
-      librevenge::RVNGPropertyList spanPropList;
-
-      const double fontSize = std::max(charFormat.format->fontSize, 1.);
-
-      spanPropList.insert("style:font-name", charFormat.format->fontName);
-      spanPropList.insert("fo:font-size", fontSize, librevenge::RVNG_POINT);
-      spanPropList.insert("fo:font-weight", charFormat.format->bold ? "bold" : "normal");
-      spanPropList.insert("fo:font-style", charFormat.format->italic ? "italic" : "normal");
-      if (charFormat.format->underline || charFormat.format->wordUnderline)
-      {
-        spanPropList.insert("style:text-underline-color", "font-color");
-        spanPropList.insert("style:text-underline-type", "single");
-        spanPropList.insert("style:text-underline-style", "solid");
-        spanPropList.insert("style:text-underline-mode", charFormat.format->wordUnderline ? "skip-white-space" : "continuous");
-      }
-      if (charFormat.format->strike)
-      {
-        spanPropList.insert("style:text-line-through-color", "font-color");
-        spanPropList.insert("style:text-line-through-mode", "continuous");
-        spanPropList.insert("style:text-line-through-type", "single");
-        spanPropList.insert("style:text-line-through-style", "solid");
-        spanPropList.insert("style:text-line-through-width", "1pt");
-      }
-      spanPropList.insert("fo:font-variant", charFormat.format->smallCaps ? "small-caps" : "normal");
-      if (charFormat.format->allCaps)
-        spanPropList.insert("fo:text-transform", "capitalize");
-      spanPropList.insert("style:text-outline", charFormat.format->outline);
-      if (charFormat.format->shadow)
-        spanPropList.insert("fo:text-shadow", "1pt 1pt");
-      spanPropList.insert("fo:color", charFormat.format->color.toString());
-
-      if (charFormat.format->subscript)
-      {
-        writeTextPosition(spanPropList, m_docProps.subscriptOffset + charFormat.format->baselineShift, m_docProps.subscriptVScale);
-        spanPropList.insert("style:text-scale", m_docProps.subscriptHScale, librevenge::RVNG_PERCENT);
-      }
-      else if (charFormat.format->superscript)
-      {
-        writeTextPosition(spanPropList, m_docProps.superscriptOffset + charFormat.format->baselineShift, m_docProps.superscriptVScale);
-        spanPropList.insert("style:text-scale", m_docProps.superscriptHScale, librevenge::RVNG_PERCENT);
-      }
-      else if (charFormat.format->superior)
-      {
-        // approximate "superior" positioning (char ascents are aligned with the cap height of the current font)
-        const double offset = (fontSize * (1.0 - m_docProps.superiorVScale)) / fontSize;
-        writeTextPosition(spanPropList, offset + charFormat.format->baselineShift, m_docProps.superiorVScale);
-        spanPropList.insert("style:text-scale", m_docProps.superiorHScale, librevenge::RVNG_PERCENT);
-      }
-      else
-      {
-        if (charFormat.format->horizontalScaling<1 || charFormat.format->horizontalScaling>1)
-        {
-          // the horizontalScaling only applies to characters and not space between two characters
-          // so divides it by two...
-          spanPropList.insert("style:text-scale", charFormat.format->horizontalScaling < 0.2 ? 0.6 : charFormat.format->horizontalScaling > 2 ? 1.5 : 1+0.5*(charFormat.format->horizontalScaling-1), librevenge::RVNG_PERCENT);
-        }
-
-        if (charFormat.format->baselineShift != 0.0)
-        {
-          writeTextPosition(spanPropList, charFormat.format->baselineShift);
-        }
-      }
-
-      if (paragraph.format->hj)
-      {
-        spanPropList.insert("fo:hyphenation-remain-char-count", std::max(int(paragraph.format->hj->minBefore), 1));
-        spanPropList.insert("fo:hyphenation-push-char-count", std::max(int(paragraph.format->hj->minAfter), 1));
-      }
-
-      m_painter->openSpan(spanPropList);
+      m_painter->openSpan(getSpanPropList(*text, j, paragraphFormat.hj));
 
       auto sourceStr = text->text.substr(spanTextStart, spanTextEnd - spanTextStart);
       RVNGString str;
@@ -1103,30 +1031,200 @@ void QXPContentCollector::drawText(const std::shared_ptr<Text> &text, const Link
   }
 }
 
-void QXPContentCollector::drawGroup(const std::shared_ptr<Group> &group, const QXPContentCollector::CollectedPage &page)
+const librevenge::RVNGPropertyList &QXPContentCollector::getParagraphPropList(const Text &text, const unsigned paragraph, const double lineHeight, const bool borderTop, const bool borderBottom)
+{
+  const auto key = std::make_tuple(text.formats, text.paragraphs.formatIndexes[paragraph], lineHeight, borderTop, borderBottom);
+  const auto it = m_paragraphPropListCache.find(key);
+  if (it != m_paragraphPropListCache.end())
+    return it->second;
+
+  librevenge::RVNGPropertyList &paragraphPropList = m_paragraphPropListCache[key];
+  const ParagraphFormat &format = text.paragraphFormat(paragraph);
+
+  paragraphPropList.insert("fo:margin-top", format.margin.top, RVNG_POINT);
+  paragraphPropList.insert("fo:margin-right", format.margin.right, RVNG_POINT);
+  paragraphPropList.insert("fo:margin-bottom", format.margin.bottom, RVNG_POINT);
+  paragraphPropList.insert("fo:margin-left", format.margin.left, RVNG_POINT);
+
+  paragraphPropList.insert("fo:text-indent", format.firstLineIndent, RVNG_POINT);
+
+  paragraphPropList.insert("fo:line-height", lineHeight, RVNG_POINT);
+
+  switch (format.alignment)
+  {
+  case HorizontalAlignment::LEFT:
+    paragraphPropList.insert("fo:text-align", "left");
+    break;
+  case HorizontalAlignment::RIGHT:
+    paragraphPropList.insert("fo:text-align", "end");
+    break;
+  case HorizontalAlignment::CENTER:
+    paragraphPropList.insert("fo:text-align", "center");
+    break;
+  case HorizontalAlignment::JUSTIFIED:
+  case HorizontalAlignment::FORCED:
+    paragraphPropList.insert("fo:text-align", "justify");
+    break;
+  }
+  paragraphPropList.insert("fo:text-align-last", "start");
+
+  if (format.hj)
+  {
+    paragraphPropList.insert("fo:hyphenate", format.hj->hyphenate);
+    if (format.hj->maxInRow == 0)
+      paragraphPropList.insert("fo:hyphenation-ladder-count", "no-limit");
+    else
+      paragraphPropList.insert("fo:hyphenation-ladder-count", int(format.hj->maxInRow));
+    paragraphPropList.insert("style:justify-single-word", format.hj->singleWordJustify);
+  }
+
+  if (!format.tabStops.empty())
+  {
+    RVNGPropertyListVector tabs;
+    for (const auto &tab : format.tabStops)
+    {
+      RVNGPropertyList tabProps;
+      tabProps.insert("style:position", tab.position, RVNG_POINT);
+      if (!tab.fillChar.empty())
+      {
+        tabProps.insert("style:leader-text", tab.fillChar);
+      }
+      switch (tab.type)
+      {
+      case TabStopType::LEFT:
+        tabProps.insert("style:type", "left");
+        break;
+      case TabStopType::RIGHT:
+        tabProps.insert("style:type", "right");
+        break;
+      case TabStopType::CENTER:
+        tabProps.insert("style:type", "center");
+        break;
+      case TabStopType::ALIGN:
+        tabProps.insert("style:type", "char");
+        tabProps.insert("style:char", tab.alignChar);
+        break;
+      }
+      tabs.append(tabProps);
+    }
+    paragraphPropList.insert("librevenge:tab-stops", tabs);
+  }
+
+  if (borderTop)
+  {
+    writeBorder(paragraphPropList, "fo:border-top", format.ruleAbove);
+  }
+  if (borderBottom)
+  {
+    writeBorder(paragraphPropList, "fo:border-bottom", format.ruleBelow);
+  }
+
+  return paragraphPropList;
+}
+
+const librevenge::RVNGPropertyList &QXPContentCollector::getSpanPropList(const Text &text, const size_t run, const std::shared_ptr<const HJ> &hj)
+{
+  const auto key = std::make_tuple(text.formats, text.charFormats.formatIndexes[run], hj);
+  const auto it = m_spanPropListCache.find(key);
+  if (it != m_spanPropListCache.end())
+    return it->second;
+
+  librevenge::RVNGPropertyList &spanPropList = m_spanPropListCache[key];
+  const CharFormat &format = text.charFormat(run);
+
+  const double fontSize = std::max(format.fontSize, 1.);
+
+  spanPropList.insert("style:font-name", format.fontName);
+  spanPropList.insert("fo:font-size", fontSize, librevenge::RVNG_POINT);
+  spanPropList.insert("fo:font-weight", format.bold ? "bold" : "normal");
+  spanPropList.insert("fo:font-style", format.italic ? "italic" : "normal");
+  if (format.underline || format.wordUnderline)
+  {
+    spanPropList.insert("style:text-underline-color", "font-color");
+    spanPropList.insert("style:text-underline-type", "single");
+    spanPropList.insert("style:text-underline-style", "solid");
+    spanPropList.insert("style:text-underline-mode", format.wordUnderline ? "skip-white-space" : "continuous");
+  }
+  if (format.strike)
+  {
+    spanPropList.insert("style:text-line-through-color", "font-color");
+    spanPropList.insert("style:text-line-through-mode", "continuous");
+    spanPropList.insert("style:text-line-through-type", "single");
+    spanPropList.insert("style:text-line-through-style", "solid");
+    spanPropList.insert("style:text-line-through-width", "1pt");
+  }
+  spanPropList.insert("fo:font-variant", format.smallCaps ? "small-caps" : "normal");
+  if (format.allCaps)
+    spanPropList.insert("fo:text-transform", "capitalize");
+  spanPropList.insert("style:text-outline", format.outline);
+  if (format.shadow)
+    spanPropList.insert("fo:text-shadow", "1pt 1pt");
+  spanPropList.insert("fo:color", format.color.toString());
+
+  if (format.subscript)
+  {
+    writeTextPosition(spanPropList, m_docProps.subscriptOffset + format.baselineShift, m_docProps.subscriptVScale);
+    spanPropList.insert("style:text-scale", m_docProps.subscriptHScale, librevenge::RVNG_PERCENT);
+  }
+  else if (format.superscript)
+  {
+    writeTextPosition(spanPropList, m_docProps.superscriptOffset + format.baselineShift, m_docProps.superscriptVScale);
+    spanPropList.insert("style:text-scale", m_docProps.superscriptHScale, librevenge::RVNG_PERCENT);
+  }
+  else if (format.superior)
+  {
+    // approximate "superior" positioning (char ascents are aligned with the cap height of the current font)
+    const double offset = (fontSize * (1.0 - m_docProps.superiorVScale)) / fontSize;
+    writeTextPosition(spanPropList, offset + format.baselineShift, m_docProps.superiorVScale);
+    spanPropList.insert("style:text-scale", m_docProps.superiorHScale, librevenge::RVNG_PERCENT);
+  }
+  else
+  {
+    if (format.horizontalScaling<1 || format.horizontalScaling>1)
+    {
+      // the horizontalScaling only applies to characters and not space between two characters
+      // so divides it by two...
+      spanPropList.insert("style:text-scale", format.horizontalScaling < 0.2 ? 0.6 : format.horizontalScaling > 2 ? 1.5 : 1+0.5*(format.horizontalScaling-1), librevenge::RVNG_PERCENT);
+    }
+
+    if (format.baselineShift != 0.0)
+    {
+      writeTextPosition(spanPropList, format.baselineShift);
+    }
+  }
+
+  if (hj)
+  {
+    spanPropList.insert("fo:hyphenation-remain-char-count", std::max(int(hj->minBefore), 1));
+    spanPropList.insert("fo:hyphenation-push-char-count", std::max(int(hj->minAfter), 1));
+  }
+
+  return spanPropList;
+}
+
+void QXPContentCollector::drawGroup(const std::shared_ptr<Group> &group, QXPContentCollector::CollectedPage &page)
 {
   bool groupOpened = false;
 
   for (const unsigned &ind : group->objectsIndexes)
   {
-    const auto it = page.objects.find(ind);
-    if (it == page.objects.end())
+    if (ind >= page.objects.size() || !page.objects[ind].object)
     {
       QXP_DEBUG_MSG(("Group element %u not found\n", ind));
       continue;
     }
-    const auto &obj = it->second;
+    auto &obj = page.objects[ind];
 
     if (!groupOpened)
     {
       RVNGPropertyList propList;
-      writeZIndex(propList, obj->zIndex() - 1);
+      writeZIndex(propList, obj.object->zIndex - 1);
       m_painter->openGroup(propList);
 
       groupOpened = true;
     }
 
-    obj->draw(page);
+    drawObject(obj, page);
   }
 
   if (groupOpened)
@@ -15,8 +15,11 @@
 #include <unordered_map>
 #include <map>
 #include <memory>
-#include <functional>
+#include <tuple>
 #include <type_traits>
+#include <utility>
+
+#include <libqxp/QXPMemoryStats.h>
 
 #include "QXPTypes.h"
 
@@ -30,11 +33,12 @@ class QXPContentCollector : public QXPCollector
   QXPContentCollector &operator=(const QXPContentCollector &other) = delete;
 
 public:
-  QXPContentCollector(librevenge::RVNGDrawingInterface *painter);
+  QXPContentCollector(librevenge::RVNGDrawingInterface *painter, QXPMemoryStats *memoryStats = nullptr);
   ~QXPContentCollector();
 
   void startDocument() override;
   void endDocument() override;
+  void abortDocument() override;
 
   void startPage(const Page &page) override;
   void endPage() override;
@@ -45,77 +49,55 @@ public:
   void collectBox(const std::shared_ptr<Box> &box) override;
 
   void collectPicture(unsigned index, librevenge::RVNGBinaryData const &pict) override;
+  void collectPendingPicture(unsigned index, const PictureFuture &picture) override;
   void collectPictureBox(const std::shared_ptr<PictureBox> &box) override;
   void collectTextBox(const std::shared_ptr<TextBox> &box) override;
   void collectTextPath(const std::shared_ptr<TextPath> &textPath) override;
   void collectGroup(const std::shared_ptr<Group> &group) override;
 
   void collectText(const std::shared_ptr<Text> &text, const unsigned linkId) override;
+  void collectPendingText(const TextFuture &text, const unsigned linkId) override;
 
 private:
-  struct CollectedPage;
-
-  template<typename T>
-  using ObjectHandler = std::function<void(const std::shared_ptr<T> &obj, const CollectedPage &)>;
-
-  template<typename T, typename TThis>
-  using ObjectHandlerMember = std::function<void(TThis *, const std::shared_ptr<T> &obj, const CollectedPage &)>;
-
-  class CollectedObjectInterface
+  enum class CollectedObjectType
   {
-  public:
-    virtual ~CollectedObjectInterface() = default;
-
-    virtual void draw(const CollectedPage &page) = 0;
-
-    virtual unsigned zIndex() const = 0;
-    virtual void setZIndex(unsigned value) = 0;
+    NONE,
+    LINE,
+    BOX,
+    PICTURE_BOX,
+    TEXT_BOX,
+    TEXT_PATH,
+    GROUP
   };
 
-  template<typename T>
-  class CollectedObject : public CollectedObjectInterface
+  struct CollectedObject
   {
-    static_assert(std::is_base_of<Object, T>::value, "T is not Object");
-  public:
-    const std::shared_ptr<T> object;
+    CollectedObjectType type;
+    bool isProcessed;
+    std::shared_ptr<Object> object;
 
-    CollectedObject(const std::shared_ptr<T> &obj, const ObjectHandler<T> &handler)
-      : object(obj), m_handler(handler), m_isProcessed(false)
+    CollectedObject()
+      : type(CollectedObjectType::NONE), isProcessed(false), object()
     { }
 
-    void draw(const CollectedPage &page) override
-    {
-      if (!m_isProcessed)
-      {
-        m_isProcessed = true;
-        m_handler(object, page);
-      }
-    }
-
-    unsigned zIndex() const override
-    {
-      return object->zIndex;
-    }
-
-    void setZIndex(unsigned value) override
+    template<typename T>
+    std::shared_ptr<T> get() const
     {
-      object->zIndex = value;
+      return std::static_pointer_cast<T>(object);
     }
-
-  private:
-    const ObjectHandler<T> m_handler;
-    bool m_isProcessed;
   };
 
   struct CollectedPage
   {
     const PageSettings settings;
-    std::vector<std::shared_ptr<CollectedObject<Group>>> groups;
+    std::vector<unsigned> groups;
     std::vector<std::shared_ptr<TextObject>> linkedTextObjects;
-    std::map<unsigned, std::shared_ptr<CollectedObjectInterface>> objects;
+    // indexed by object index, objects that went to the other facing page are left empty
+    std::vector<CollectedObject> objects;
+    unsigned long memorySize;
 
     CollectedPage(const PageSettings &pageSettings)
-      : settings(pageSettings), groups(), linkedTextObjects(), objects()
+      : settings(pageSettings), groups(), linkedTextObjects(), objects(), memorySize(0)
     { }
 
     double getX(const double x) const;
@@ -125,7 +107,21 @@ private:
     Point getPoint(const Point &p) const;
   };
 
+  // text or picture that may still be loaded in the background; it is accounted for once it is there
+  template<typename T>
+  struct PendingContent
+  {
+    std::shared_future<T> value;
+    bool isAccounted;
+    unsigned long memorySize;
+
+    PendingContent()
+      : value(), isAccounted(false), memorySize(0)
+    { }
+  };
+
   librevenge::RVNGDrawingInterface *m_painter;
+  QXPMemoryStats *m_memoryStats;
 
   bool m_isDocumentStarted;
   bool m_isCollectingFacingPage;
@@ -133,24 +129,46 @@ private:
 
   std::vector<CollectedPage> m_unprocessedPages;
 
-  std::unordered_map<unsigned, librevenge::RVNGBinaryData> m_indexPictureDataMap;
-  std::unordered_map<unsigned, std::shared_ptr<Text>> m_linkTextMap;
+  std::unordered_map<unsigned, PendingContent<librevenge::RVNGBinaryData>> m_indexPictureDataMap;
+  std::unordered_map<unsigned, PendingContent<std::shared_ptr<Text>>> m_linkTextMap;
   std::unordered_map<unsigned, std::unordered_map<unsigned, std::shared_ptr<TextObject>>> m_linkIndexedTextObjectsMap;
 
   QXPDocumentProperties m_docProps;
 
+  // property lists depend only on the format and on a few position-dependent values, so they are created once;
+  // formats are keyed by the formats of the text and their index, which keeps the formats alive
+  std::map<std::tuple<std::shared_ptr<const TextFormats>, unsigned, double, bool, bool>, librevenge::RVNGPropertyList> m_paragraphPropListCache;
+  std::map<std::tuple<std::shared_ptr<const TextFormats>, unsigned, std::shared_ptr<const HJ>>, librevenge::RVNGPropertyList> m_spanPropListCache;
+
   CollectedPage &getInsertionPage(const std::shared_ptr<Object> &obj);
 
   template<typename T>
-  std::shared_ptr<CollectedObject<T>> addObject(const std::shared_ptr<T> &obj, const ObjectHandlerMember<T, QXPContentCollector> &handler)
+  CollectedPage &addObject(const std::shared_ptr<T> &obj, const CollectedObjectType type)
   {
-    auto collectedObj = std::make_shared<CollectedObject<T>>(obj, std::bind(handler, this, std::placeholders::_1, std::placeholders::_2));
-    getInsertionPage(obj).objects[m_currentObjectIndex] = collectedObj;
+    static_assert(std::is_base_of<Object, T>::value, "T is not Object");
+    auto &page = getInsertionPage(obj);
+    if (page.objects.size() <= m_currentObjectIndex)
+      page.objects.resize(m_currentObjectIndex + 1);
+    auto &collectedObj = page.objects[m_currentObjectIndex];
+    collectedObj.type = type;
+    collectedObj.object = obj;
+    addPageMemory(page, sizeof(T));
     ++m_currentObjectIndex;
-    return collectedObj;
+    return page;
   }
 
+  void addPageMemory(CollectedPage &page, unsigned long size);
+  template<typename T>
+  void setContent(PendingContent<T> &content, const std::shared_future<T> &value, QXPMemoryStats::Category category);
+  // waits until the content is loaded
+  template<typename T>
+  const T &getContent(PendingContent<T> &content, QXPMemoryStats::Category category);
+  // waits until the text of textObj is decoded; returns false if it has none
+  bool resolveText(TextObject &textObj);
+  bool hasText(const TextObject &textObj) const;
+
   void draw(bool force = false);
+  void drawObject(CollectedObject &obj, CollectedPage &page);
 
   void collectTextObject(const std::shared_ptr<TextObject> &textObj, CollectedPage &page);
   void updateLinkedTexts();
@@ -166,7 +184,10 @@ private:
   void drawTextBox(const std::shared_ptr<TextBox> &textbox, const CollectedPage &page);
   void drawTextPath(const std::shared_ptr<TextPath> &textPath, const CollectedPage &page);
   void drawText(const std::shared_ptr<Text> &text, const LinkedTextSettings &linkSettings);
-  void drawGroup(const std::shared_ptr<Group> &group, const CollectedPage &page);
+  void drawGroup(const std::shared_ptr<Group> &group, CollectedPage &page);
+
+  const librevenge::RVNGPropertyList &getParagraphPropList(const Text &text, unsigned paragraph, double lineHeight, bool borderTop, bool borderBottom);
+  const librevenge::RVNGPropertyList &getSpanPropList(const Text &text, size_t run, const std::shared_ptr<const HJ> &hj);
 
   void writeFill(librevenge::RVNGPropertyList &propList, const boost::optional<Fill> &fill);
   void writeFrame(librevenge::RVNGPropertyList &propList, const Frame &frame, const bool runaround, const bool allowHairline = false);
@@ -0,0 +1,27 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libqxp/QXPCostEstimate.h>
+
+namespace libqxp
+{
+
+QXPCostEstimate::QXPCostEstimate()
+  : blockCount(0)
+  , documentChainLength(0)
+  , pageCount(0)
+  , contentLength(0)
+  , cpuTime(0)
+  , peakMemory(0)
+{
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -27,6 +27,11 @@ uint8_t QXPDeobfuscator::operator()(uint8_t value) const
   return operator()(uint16_t(value)) & 0xff;
 }
 
+uint16_t QXPDeobfuscator::seed() const
+{
+  return m_seed;
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -21,6 +21,8 @@ public:
   uint16_t operator()(uint16_t value) const;
   uint8_t operator()(uint8_t value) const;
 
+  uint16_t seed() const;
+
 protected:
   uint16_t m_seed;
 
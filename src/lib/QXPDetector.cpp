@@ -16,7 +16,7 @@
 #include "QXPMacFileParser.h"
 #include "QXPParser.h"
 
-#include <iostream>
+#include <cstring>
 namespace libqxp
 {
 
@@ -70,17 +70,105 @@ private:
   }
 };
 
+
+enum class Magic
+{
+  UNKNOWN,
+  CONTAINER,
+  QXP1,
+  QXP3
+};
+
+const unsigned long SNIFF_LENGTH = 64;
+const unsigned long MIN_QXP1_MAIN_CHAIN_LENGTH = 200;
+
+uint16_t getU16BE(const unsigned char *const data)
+{
+  return uint16_t((data[0] << 8) | data[1]);
+}
+
+uint32_t getU32BE(const unsigned char *const data)
+{
+  return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | uint32_t(data[3]);
+}
+
+Magic sniff(const std::shared_ptr<librevenge::RVNGInputStream> &input)
+{
+  input->seek(0, librevenge::RVNG_SEEK_SET);
+  unsigned long numBytesRead = 0;
+  const unsigned char *const data = input->read(SNIFF_LENGTH, numBytesRead);
+  if (!data || numBytesRead == 0)
+  {
+    // e.g., a directory-based structured stream
+    return input->isStructured() ? Magic::CONTAINER : Magic::UNKNOWN;
+  }
+  if (numBytesRead < 4)
+    return Magic::UNKNOWN;
+
+  static const char binHex[] = "(This file must be converted with BinHex";
+  if (numBytesRead >= sizeof(binHex) - 1 && std::memcmp(data, binHex, sizeof(binHex) - 1) == 0)
+    return Magic::CONTAINER;
+  switch (getU32BE(data))
+  {
+  case 0x504b0304: // zip
+  case 0x504b0506: // empty zip
+  case 0xd0cf11e0: // OLE
+  case 0x00051600: // AppleSingle
+  case 0x00051607: // AppleDouble
+    return Magic::CONTAINER;
+  default:
+    break;
+  }
+
+  if (numBytesRead >= 10 && std::memcmp(data + 4, "XPR", 3) == 0)
+    return Magic::QXP3;
+  const uint16_t version = getU16BE(data);
+  if ((version == QXP_1 || version == QXP_2) && getU16BE(data + 2) == version)
+    return Magic::QXP1;
+  return Magic::UNKNOWN;
+}
+
 }
 
 QXPDetector::QXPDetector()
   : m_input()
   , m_header()
   , m_type(QXPDocument::TYPE_UNKNOWN)
+  , m_wrapper(QXPDocument::WRAPPER_NONE)
   , m_supported(false)
 {
 }
 
 void QXPDetector::detect(const std::shared_ptr<librevenge::RVNGInputStream> &input)
+{
+  // The first bytes of the input are enough to tell plain documents,
+  // containers and other files apart, so the expensive checks are only
+  // done if they have a chance to succeed.
+  switch (sniff(input))
+  {
+  case Magic::CONTAINER:
+    detectContainer(input);
+    break;
+  case Magic::QXP3:
+    detectQXP3(input, boost::none);
+    break;
+  case Magic::QXP1:
+    detectQXP1(input);
+    break;
+  default:
+    break;
+  }
+
+  if (bool(m_header))
+  {
+    m_input->seek(0, librevenge::RVNG_SEEK_SET);
+    m_header->load(m_input);
+    m_type = m_header->getType();
+    m_supported = m_type != QXPDocument::TYPE_UNKNOWN;
+  }
+}
+
+void QXPDetector::detectContainer(const std::shared_ptr<librevenge::RVNGInputStream> &input)
 {
   boost::optional<QXPDocument::Type> docType;
 
@@ -90,6 +178,7 @@ void QXPDetector::detect(const std::shared_ptr<librevenge::RVNGInputStream> &inp
   QXPMacFileParser macFile(docStream, type, creator);
   if (macFile.parse(input))
   {
+    m_wrapper = macFile.wrapper();
     if (creator == "XPR3")
     {
       if (type == "XDOC")
@@ -105,6 +194,7 @@ void QXPDetector::detect(const std::shared_ptr<librevenge::RVNGInputStream> &inp
     {
       m_input = docStream;
       m_header = std::make_shared<QXP1Header>();
+      return;
     }
   }
   else
@@ -112,47 +202,47 @@ void QXPDetector::detect(const std::shared_ptr<librevenge::RVNGInputStream> &inp
     docStream = input;
   }
 
-  if (!m_header)
-  {
-    QXP3Detector detector;
-    if (detector.load(docStream) && detector.isSupported())
-    {
-      m_input = docStream;
-      m_header = detector.createHeader(docType);
-    }
-  }
+  if (!docStream)
+    return;
 
-  if (!bool(m_header) && bool(docStream))
+  switch (sniff(docStream))
   {
-    docStream->seek(0, librevenge::RVNG_SEEK_SET);
-    unsigned const vers=readU16(docStream, true);
-
-    if ((vers==QXP_1 || vers==QXP_2) && readU16(docStream, true)==vers)
-    {
-      m_header = std::make_shared<QXP1Header>();
-      // detection is very weak, check if we can retrieve the main
-      // block parser and if it is long enough
-      docStream->seek(0, librevenge::RVNG_SEEK_SET);
-      m_header->load(docStream);
-      QXPBlockParser blockParser(docStream, m_header);
-      auto mainStream=blockParser.getChain(3);
-      if (mainStream)
-        mainStream->seek(200, librevenge::RVNG_SEEK_SET); // ~ 194=two empty master page data
-      if (!mainStream || mainStream->tell()<190)
-        m_header.reset();
-      else
-        m_input=docStream;
-    }
+  case Magic::QXP3:
+    detectQXP3(docStream, docType);
+    break;
+  case Magic::QXP1:
+    detectQXP1(docStream);
+    break;
+  default:
+    break;
   }
-  if (bool(m_header))
+}
+
+void QXPDetector::detectQXP3(const std::shared_ptr<librevenge::RVNGInputStream> &docStream, const boost::optional<QXPDocument::Type> &docType)
+{
+  QXP3Detector detector;
+  if (detector.load(docStream) && detector.isSupported())
   {
-    m_input->seek(0, librevenge::RVNG_SEEK_SET);
-    m_header->load(m_input);
-    m_type = m_header->getType();
-    m_supported = m_type != QXPDocument::TYPE_UNKNOWN;
+    m_input = docStream;
+    m_header = detector.createHeader(docType);
   }
 }
 
+void QXPDetector::detectQXP1(const std::shared_ptr<librevenge::RVNGInputStream> &docStream)
+{
+  m_header = std::make_shared<QXP1Header>();
+  // detection is very weak, check if we can retrieve the main
+  // block parser and if it is long enough
+  docStream->seek(0, librevenge::RVNG_SEEK_SET);
+  m_header->load(docStream);
+  QXPBlockParser blockParser(docStream, m_header);
+  // ~ 194=two empty master page data
+  if (blockParser.getChainLength(3, MIN_QXP1_MAIN_CHAIN_LENGTH) < MIN_QXP1_MAIN_CHAIN_LENGTH)
+    m_header.reset();
+  else
+    m_input = docStream;
+}
+
 const std::shared_ptr<librevenge::RVNGInputStream> &QXPDetector::input() const
 {
   return m_input;
@@ -173,6 +263,11 @@ QXPDocument::Type QXPDetector::type() const
   return m_type;
 }
 
+QXPDocument::Wrapper QXPDetector::wrapper() const
+{
+  return m_wrapper;
+}
+
 } // namespace libqxp
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
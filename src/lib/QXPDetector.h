@@ -12,6 +12,8 @@
 
 #include <memory>
 
+#include <boost/optional.hpp>
+
 #include <librevenge-stream/librevenge-stream.h>
 
 #include <libqxp/libqxp.h>
@@ -33,11 +35,17 @@ public:
   const std::shared_ptr<QXPHeader> &header() const;
   bool isSupported() const;
   QXPDocument::Type type() const;
+  QXPDocument::Wrapper wrapper() const;
 
 private:
+  void detectContainer(const std::shared_ptr<librevenge::RVNGInputStream> &input);
+  void detectQXP3(const std::shared_ptr<librevenge::RVNGInputStream> &docStream, const boost::optional<QXPDocument::Type> &docType);
+  void detectQXP1(const std::shared_ptr<librevenge::RVNGInputStream> &docStream);
+
   std::shared_ptr<librevenge::RVNGInputStream> m_input;
   std::shared_ptr<QXPHeader> m_header;
   QXPDocument::Type m_type;
+  QXPDocument::Wrapper m_wrapper;
   bool m_supported;
 };
 
@@ -16,9 +16,12 @@
 #include <libqxp/libqxp.h>
 
 #include "libqxp_utils.h"
+#include "QXPBlockParser.h"
 #include "QXPDetector.h"
 #include "QXPHeader.h"
+#include "QXPInventoryCollector.h"
 #include "QXPParser.h"
+#include "QXPTextCollector.h"
 
 using librevenge::RVNGInputStream;
 
@@ -28,6 +31,49 @@ using std::shared_ptr;
 namespace libqxp
 {
 
+namespace
+{
+
+// Rough costs of parts of the import, in seconds or bytes per unit.
+// They are orders of magnitude, not measurements: only their ratios
+// matter for ordering and packing jobs.
+
+// seconds per block of the file, for following the links between blocks
+const double CPU_PER_BLOCK = 1e-7;
+// seconds per byte of the document chain, which holds the formats and
+// the objects of all pages and is decoded record by record
+const double CPU_PER_DOCUMENT_BYTE = 2e-8;
+// seconds per page, for drawing it
+const double CPU_PER_PAGE = 1e-4;
+// seconds per byte of the rest of the file. Pictures there are just
+// copied, while stories are decoded character by character, about a
+// hundred times slower per byte. They cannot be told apart without
+// reading the objects, so this assumes mostly picture data.
+const double CPU_PER_CONTENT_BYTE = 1e-8;
+
+// bytes per page, for its objects, which are held until it is drawn
+const unsigned long MEMORY_PER_PAGE = 16 * 1024;
+// bytes per byte of the rest of the file: loaded stories and pictures
+// are held until their page is drawn, in addition to their copy in the
+// output
+const unsigned long MEMORY_PER_CONTENT_BYTE = 2;
+
+void computeEstimate(QXPCostEstimate &estimate)
+{
+  estimate.cpuTime =
+    CPU_PER_BLOCK * estimate.blockCount
+    + CPU_PER_DOCUMENT_BYTE * estimate.documentChainLength
+    + CPU_PER_PAGE * estimate.pageCount
+    + CPU_PER_CONTENT_BYTE * estimate.contentLength;
+  // the whole document chain is held in memory for the duration of the parse
+  estimate.peakMemory =
+    estimate.documentChainLength
+    + MEMORY_PER_PAGE * estimate.pageCount
+    + MEMORY_PER_CONTENT_BYTE * estimate.contentLength;
+}
+
+}
+
 QXPAPI bool QXPDocument::isSupported(librevenge::RVNGInputStream *const input, Type *const type) try
 {
   QXPDetector detector;
@@ -41,7 +87,50 @@ catch (...)
   return false;
 }
 
-QXPAPI QXPDocument::Result QXPDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGDrawingInterface *const document, QXPPathResolver * /*resolver*/) try
+QXPAPI QXPDocument::Result QXPDocument::getInfo(librevenge::RVNGInputStream *const input, Info &info) try
+{
+  info = Info();
+
+  QXPDetector detector;
+  detector.detect(std::shared_ptr<librevenge::RVNGInputStream>(input, QXPDummyDeleter()));
+  if (!detector.isSupported())
+    return RESULT_UNSUPPORTED_FORMAT;
+
+  const auto &header = detector.header();
+  info.version = header->version();
+  info.bigEndian = header->isBigEndian();
+  info.type = detector.type();
+  info.pageCount = header->pagesCount();
+  info.masterPageCount = header->masterPagesCount();
+  info.encoding = header->encoding();
+  info.wrapper = detector.wrapper();
+
+  return RESULT_OK;
+}
+catch (const FileAccessError &)
+{
+  return RESULT_FILE_ACCESS_ERROR;
+}
+catch (const UnsupportedFormat &)
+{
+  return RESULT_UNSUPPORTED_FORMAT;
+}
+catch (...)
+{
+  return RESULT_UNKNOWN_ERROR;
+}
+
+QXPAPI QXPDocument::Result QXPDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGDrawingInterface *const document, QXPPathResolver *const resolver)
+{
+  return parse(input, document, resolver, nullptr);
+}
+
+QXPAPI QXPDocument::Result QXPDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGDrawingInterface *const document, QXPPathResolver *const resolver, QXPMemoryStats *const stats)
+{
+  return parse(input, document, resolver, stats, nullptr);
+}
+
+QXPAPI QXPDocument::Result QXPDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGDrawingInterface *const document, QXPPathResolver * /*resolver*/, QXPMemoryStats *const stats, QXPParseOptions *const options) try
 {
   QXPDetector detector;
   detector.detect(std::shared_ptr<librevenge::RVNGInputStream>(input, QXPDummyDeleter()));
@@ -52,9 +141,117 @@ QXPAPI QXPDocument::Result QXPDocument::parse(librevenge::RVNGInputStream *const
     return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
 
   auto parser = detector.header()->createParser(detector.input(), document);
+  parser->setMemoryStats(stats);
+  parser->setMaxThreads(options ? options->maxThreads() : 1);
+  parser->setParseOptions(options);
 
   return parser->parse() ? RESULT_OK : RESULT_UNKNOWN_ERROR;
 }
+catch (const ParseCancelled &)
+{
+  return RESULT_CANCELLED;
+}
+catch (const DeadlineExceeded &)
+{
+  return RESULT_DEADLINE_EXCEEDED;
+}
+catch (const FileAccessError &)
+{
+  return RESULT_FILE_ACCESS_ERROR;
+}
+catch (const UnsupportedFormat &)
+{
+  return RESULT_UNSUPPORTED_FORMAT;
+}
+catch (...)
+{
+  return RESULT_UNKNOWN_ERROR;
+}
+
+QXPAPI QXPDocument::Result QXPDocument::extractText(librevenge::RVNGInputStream *const input, QXPTextSink *const sink, QXPPathResolver * /*resolver*/) try
+{
+  QXPDetector detector;
+  detector.detect(std::shared_ptr<librevenge::RVNGInputStream>(input, QXPDummyDeleter()));
+  if (!detector.isSupported())
+    return RESULT_UNSUPPORTED_FORMAT;
+
+  if (detector.type() != QXPDocument::TYPE_DOCUMENT && detector.type() != QXPDocument::TYPE_TEMPLATE)
+    return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+
+  auto parser = detector.header()->createParser(detector.input(), nullptr);
+  QXPTextCollector collector(sink);
+
+  return parser->parse(collector) ? RESULT_OK : RESULT_UNKNOWN_ERROR;
+}
+catch (const FileAccessError &)
+{
+  return RESULT_FILE_ACCESS_ERROR;
+}
+catch (const UnsupportedFormat &)
+{
+  return RESULT_UNSUPPORTED_FORMAT;
+}
+catch (...)
+{
+  return RESULT_UNKNOWN_ERROR;
+}
+
+QXPAPI QXPDocument::Result QXPDocument::getInventory(librevenge::RVNGInputStream *const input, QXPInventory &inventory) try
+{
+  QXPDetector detector;
+  detector.detect(std::shared_ptr<librevenge::RVNGInputStream>(input, QXPDummyDeleter()));
+  if (!detector.isSupported())
+    return RESULT_UNSUPPORTED_FORMAT;
+
+  if (detector.type() != QXPDocument::TYPE_DOCUMENT && detector.type() != QXPDocument::TYPE_TEMPLATE)
+    return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+
+  inventory = QXPInventory();
+  inventory.version = detector.header()->version();
+
+  auto parser = detector.header()->createParser(detector.input(), nullptr);
+  QXPInventoryCollector collector(inventory);
+
+  return parser->parse(collector) ? RESULT_OK : RESULT_UNKNOWN_ERROR;
+}
+catch (const FileAccessError &)
+{
+  return RESULT_FILE_ACCESS_ERROR;
+}
+catch (const UnsupportedFormat &)
+{
+  return RESULT_UNSUPPORTED_FORMAT;
+}
+catch (...)
+{
+  return RESULT_UNKNOWN_ERROR;
+}
+
+QXPAPI QXPDocument::Result QXPDocument::estimateCost(librevenge::RVNGInputStream *const input, QXPCostEstimate &estimate) try
+{
+  estimate = QXPCostEstimate();
+
+  QXPDetector detector;
+  detector.detect(std::shared_ptr<librevenge::RVNGInputStream>(input, QXPDummyDeleter()));
+  if (!detector.isSupported())
+    return RESULT_UNSUPPORTED_FORMAT;
+
+  if (detector.type() != QXPDocument::TYPE_DOCUMENT && detector.type() != QXPDocument::TYPE_TEMPLATE)
+    return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+
+  const auto &header = detector.header();
+  estimate.pageCount = header->pagesCount() + header->masterPagesCount();
+
+  QXPBlockParser blockParser(detector.input(), header);
+  estimate.blockCount = blockParser.blockCount();
+  estimate.documentChainLength = blockParser.getChainLength(3);
+  const unsigned long fileLength = static_cast<unsigned long>(blockParser.blockCount()) * blockParser.blockLength();
+  if (fileLength > estimate.documentChainLength)
+    estimate.contentLength = fileLength - estimate.documentChainLength;
+  computeEstimate(estimate);
+
+  return RESULT_OK;
+}
 catch (const FileAccessError &)
 {
   return RESULT_FILE_ACCESS_ERROR;
@@ -0,0 +1,158 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libqxp/QXPDocumentReader.h>
+
+#include "libqxp_utils.h"
+#include "QXPContentCollector.h"
+#include "QXPDetector.h"
+#include "QXPDrawingRecorder.h"
+#include "QXPHeader.h"
+#include "QXPParser.h"
+
+namespace libqxp
+{
+
+struct QXPDocumentReader::Impl
+{
+  Impl();
+
+  // drops the parsing state; pages recorded completely can still be drawn
+  void finish();
+  // drops everything, as the recorded output may be incomplete
+  void fail();
+
+  // pages are recorded until they are asked for, as the collector may draw several at once
+  QXPDrawingRecorder recorder;
+  std::unique_ptr<QXPParser> parser;
+  std::unique_ptr<QXPContentCollector> collector;
+};
+
+QXPDocumentReader::Impl::Impl()
+  : recorder()
+  , parser()
+  , collector()
+{
+}
+
+void QXPDocumentReader::Impl::finish()
+{
+  // the collector may still draw, so it goes before the parser
+  collector.reset();
+  parser.reset();
+}
+
+void QXPDocumentReader::Impl::fail()
+{
+  if (collector)
+    collector->abortDocument();
+  finish();
+  recorder.clear();
+}
+
+QXPDocumentReader::QXPDocumentReader()
+  : m_impl(new Impl())
+{
+}
+
+QXPDocumentReader::~QXPDocumentReader()
+{
+}
+
+QXPDocument::Result QXPDocumentReader::open(librevenge::RVNGInputStream *const input) try
+{
+  m_impl.reset(new Impl());
+
+  QXPDetector detector;
+  detector.detect(std::shared_ptr<librevenge::RVNGInputStream>(input, QXPDummyDeleter()));
+  if (!detector.isSupported())
+    return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+
+  if (detector.type() != QXPDocument::TYPE_DOCUMENT && detector.type() != QXPDocument::TYPE_TEMPLATE)
+    return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+
+  m_impl->parser = detector.header()->createParser(detector.input(), nullptr);
+  m_impl->parser->setStreamPages(true);
+  m_impl->collector.reset(new QXPContentCollector(&m_impl->recorder, nullptr));
+
+  if (!m_impl->parser->startPages(*m_impl->collector))
+  {
+    m_impl->fail();
+    return QXPDocument::RESULT_UNKNOWN_ERROR;
+  }
+
+  return QXPDocument::RESULT_OK;
+}
+catch (const FileAccessError &)
+{
+  m_impl->fail();
+  return QXPDocument::RESULT_FILE_ACCESS_ERROR;
+}
+catch (const UnsupportedFormat &)
+{
+  m_impl->fail();
+  return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+}
+catch (...)
+{
+  m_impl->fail();
+  return QXPDocument::RESULT_UNKNOWN_ERROR;
+}
+
+QXPDocument::Result QXPDocumentReader::nextPage(librevenge::RVNGDrawingInterface *const painter) try
+{
+  Impl &impl = *m_impl;
+
+  while (impl.recorder.completePages() == 0 && impl.parser)
+  {
+    impl.parser->parseNextPage(*impl.collector);
+    if (!impl.parser->hasNextPage())
+    {
+      // draws the pages still waiting for continued text
+      impl.collector->endDocument();
+      impl.finish();
+    }
+  }
+
+  if (impl.recorder.completePages() == 0)
+    return QXPDocument::RESULT_OK;
+
+  painter->startDocument(librevenge::RVNGPropertyList());
+  impl.recorder.replayPage(painter);
+  painter->endDocument();
+
+  if (isDone())
+    impl.recorder.clear();
+
+  return QXPDocument::RESULT_OK;
+}
+catch (const FileAccessError &)
+{
+  m_impl->fail();
+  return QXPDocument::RESULT_FILE_ACCESS_ERROR;
+}
+catch (const UnsupportedFormat &)
+{
+  m_impl->fail();
+  return QXPDocument::RESULT_UNSUPPORTED_FORMAT;
+}
+catch (...)
+{
+  m_impl->fail();
+  return QXPDocument::RESULT_UNKNOWN_ERROR;
+}
+
+bool QXPDocumentReader::isDone() const
+{
+  return !m_impl->parser && m_impl->recorder.completePages() == 0;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,493 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPDrawingRecorder.h"
+
+#include <algorithm>
+
+namespace libqxp
+{
+
+QXPDrawingRecorder::Call::Call(const Type type_)
+  : type(type_)
+  , propList()
+  , text()
+{
+}
+
+QXPDrawingRecorder::Call::Call(const Type type_, const librevenge::RVNGPropertyList &propList_)
+  : type(type_)
+  , propList(propList_)
+  , text()
+{
+}
+
+QXPDrawingRecorder::Call::Call(const Type type_, const librevenge::RVNGString &text_)
+  : type(type_)
+  , propList()
+  , text(text_)
+{
+}
+
+QXPDrawingRecorder::QXPDrawingRecorder()
+  : m_calls()
+  , m_completePages(0)
+{
+}
+
+void QXPDrawingRecorder::replay(librevenge::RVNGDrawingInterface *const painter, const bool withDocument) const
+{
+  replay(painter, m_calls.begin(), m_calls.end(), withDocument);
+}
+
+unsigned QXPDrawingRecorder::completePages() const
+{
+  return m_completePages;
+}
+
+bool QXPDrawingRecorder::replayPage(librevenge::RVNGDrawingInterface *const painter)
+{
+  if (m_completePages == 0)
+    return false;
+
+  const auto end = std::find_if(m_calls.begin(), m_calls.end(), [](const Call &call)
+  {
+    return call.type == Call::END_PAGE;
+  }) + 1;
+  replay(painter, m_calls.begin(), end, false);
+
+  m_calls.erase(m_calls.begin(), end);
+  --m_completePages;
+  return true;
+}
+
+void QXPDrawingRecorder::replay(librevenge::RVNGDrawingInterface *const painter, const CallIterator begin, const CallIterator end, const bool withDocument)
+{
+  for (auto it = begin; it != end; ++it)
+  {
+    const Call &call = *it;
+    switch (call.type)
+    {
+    case Call::START_DOCUMENT:
+      if (withDocument)
+        painter->startDocument(call.propList);
+      break;
+    case Call::END_DOCUMENT:
+      if (withDocument)
+        painter->endDocument();
+      break;
+    case Call::SET_DOCUMENT_META_DATA:
+      if (withDocument)
+        painter->setDocumentMetaData(call.propList);
+      break;
+    case Call::DEFINE_EMBEDDED_FONT:
+      painter->defineEmbeddedFont(call.propList);
+      break;
+    case Call::START_PAGE:
+      painter->startPage(call.propList);
+      break;
+    case Call::END_PAGE:
+      painter->endPage();
+      break;
+    case Call::START_MASTER_PAGE:
+      painter->startMasterPage(call.propList);
+      break;
+    case Call::END_MASTER_PAGE:
+      painter->endMasterPage();
+      break;
+    case Call::START_LAYER:
+      painter->startLayer(call.propList);
+      break;
+    case Call::END_LAYER:
+      painter->endLayer();
+      break;
+    case Call::START_EMBEDDED_GRAPHICS:
+      painter->startEmbeddedGraphics(call.propList);
+      break;
+    case Call::END_EMBEDDED_GRAPHICS:
+      painter->endEmbeddedGraphics();
+      break;
+    case Call::OPEN_GROUP:
+      painter->openGroup(call.propList);
+      break;
+    case Call::CLOSE_GROUP:
+      painter->closeGroup();
+      break;
+    case Call::SET_STYLE:
+      painter->setStyle(call.propList);
+      break;
+    case Call::DRAW_RECTANGLE:
+      painter->drawRectangle(call.propList);
+      break;
+    case Call::DRAW_ELLIPSE:
+      painter->drawEllipse(call.propList);
+      break;
+    case Call::DRAW_POLYGON:
+      painter->drawPolygon(call.propList);
+      break;
+    case Call::DRAW_POLYLINE:
+      painter->drawPolyline(call.propList);
+      break;
+    case Call::DRAW_PATH:
+      painter->drawPath(call.propList);
+      break;
+    case Call::DRAW_GRAPHIC_OBJECT:
+      painter->drawGraphicObject(call.propList);
+      break;
+    case Call::DRAW_CONNECTOR:
+      painter->drawConnector(call.propList);
+      break;
+    case Call::START_TEXT_OBJECT:
+      painter->startTextObject(call.propList);
+      break;
+    case Call::END_TEXT_OBJECT:
+      painter->endTextObject();
+      break;
+    case Call::START_TABLE_OBJECT:
+      painter->startTableObject(call.propList);
+      break;
+    case Call::OPEN_TABLE_ROW:
+      painter->openTableRow(call.propList);
+      break;
+    case Call::CLOSE_TABLE_ROW:
+      painter->closeTableRow();
+      break;
+    case Call::OPEN_TABLE_CELL:
+      painter->openTableCell(call.propList);
+      break;
+    case Call::CLOSE_TABLE_CELL:
+      painter->closeTableCell();
+      break;
+    case Call::INSERT_COVERED_TABLE_CELL:
+      painter->insertCoveredTableCell(call.propList);
+      break;
+    case Call::END_TABLE_OBJECT:
+      painter->endTableObject();
+      break;
+    case Call::OPEN_ORDERED_LIST_LEVEL:
+      painter->openOrderedListLevel(call.propList);
+      break;
+    case Call::CLOSE_ORDERED_LIST_LEVEL:
+      painter->closeOrderedListLevel();
+      break;
+    case Call::OPEN_UNORDERED_LIST_LEVEL:
+      painter->openUnorderedListLevel(call.propList);
+      break;
+    case Call::CLOSE_UNORDERED_LIST_LEVEL:
+      painter->closeUnorderedListLevel();
+      break;
+    case Call::OPEN_LIST_ELEMENT:
+      painter->openListElement(call.propList);
+      break;
+    case Call::CLOSE_LIST_ELEMENT:
+      painter->closeListElement();
+      break;
+    case Call::DEFINE_PARAGRAPH_STYLE:
+      painter->defineParagraphStyle(call.propList);
+      break;
+    case Call::OPEN_PARAGRAPH:
+      painter->openParagraph(call.propList);
+      break;
+    case Call::CLOSE_PARAGRAPH:
+      painter->closeParagraph();
+      break;
+    case Call::DEFINE_CHARACTER_STYLE:
+      painter->defineCharacterStyle(call.propList);
+      break;
+    case Call::OPEN_SPAN:
+      painter->openSpan(call.propList);
+      break;
+    case Call::CLOSE_SPAN:
+      painter->closeSpan();
+      break;
+    case Call::OPEN_LINK:
+      painter->openLink(call.propList);
+      break;
+    case Call::CLOSE_LINK:
+      painter->closeLink();
+      break;
+    case Call::INSERT_TAB:
+      painter->insertTab();
+      break;
+    case Call::INSERT_SPACE:
+      painter->insertSpace();
+      break;
+    case Call::INSERT_TEXT:
+      painter->insertText(call.text);
+      break;
+    case Call::INSERT_LINE_BREAK:
+      painter->insertLineBreak();
+      break;
+    case Call::INSERT_FIELD:
+      painter->insertField(call.propList);
+      break;
+    }
+  }
+}
+
+void QXPDrawingRecorder::clear()
+{
+  m_calls.clear();
+  m_completePages = 0;
+}
+
+void QXPDrawingRecorder::startDocument(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_DOCUMENT, propList));
+}
+
+void QXPDrawingRecorder::endDocument()
+{
+  m_calls.push_back(Call(Call::END_DOCUMENT));
+}
+
+void QXPDrawingRecorder::setDocumentMetaData(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::SET_DOCUMENT_META_DATA, propList));
+}
+
+void QXPDrawingRecorder::defineEmbeddedFont(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DEFINE_EMBEDDED_FONT, propList));
+}
+
+void QXPDrawingRecorder::startPage(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_PAGE, propList));
+}
+
+void QXPDrawingRecorder::endPage()
+{
+  m_calls.push_back(Call(Call::END_PAGE));
+  ++m_completePages;
+}
+
+void QXPDrawingRecorder::startMasterPage(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_MASTER_PAGE, propList));
+}
+
+void QXPDrawingRecorder::endMasterPage()
+{
+  m_calls.push_back(Call(Call::END_MASTER_PAGE));
+}
+
+void QXPDrawingRecorder::startLayer(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_LAYER, propList));
+}
+
+void QXPDrawingRecorder::endLayer()
+{
+  m_calls.push_back(Call(Call::END_LAYER));
+}
+
+void QXPDrawingRecorder::startEmbeddedGraphics(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_EMBEDDED_GRAPHICS, propList));
+}
+
+void QXPDrawingRecorder::endEmbeddedGraphics()
+{
+  m_calls.push_back(Call(Call::END_EMBEDDED_GRAPHICS));
+}
+
+void QXPDrawingRecorder::openGroup(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_GROUP, propList));
+}
+
+void QXPDrawingRecorder::closeGroup()
+{
+  m_calls.push_back(Call(Call::CLOSE_GROUP));
+}
+
+void QXPDrawingRecorder::setStyle(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::SET_STYLE, propList));
+}
+
+void QXPDrawingRecorder::drawRectangle(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_RECTANGLE, propList));
+}
+
+void QXPDrawingRecorder::drawEllipse(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_ELLIPSE, propList));
+}
+
+void QXPDrawingRecorder::drawPolygon(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_POLYGON, propList));
+}
+
+void QXPDrawingRecorder::drawPolyline(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_POLYLINE, propList));
+}
+
+void QXPDrawingRecorder::drawPath(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_PATH, propList));
+}
+
+void QXPDrawingRecorder::drawGraphicObject(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_GRAPHIC_OBJECT, propList));
+}
+
+void QXPDrawingRecorder::drawConnector(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DRAW_CONNECTOR, propList));
+}
+
+void QXPDrawingRecorder::startTextObject(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_TEXT_OBJECT, propList));
+}
+
+void QXPDrawingRecorder::endTextObject()
+{
+  m_calls.push_back(Call(Call::END_TEXT_OBJECT));
+}
+
+void QXPDrawingRecorder::startTableObject(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::START_TABLE_OBJECT, propList));
+}
+
+void QXPDrawingRecorder::openTableRow(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_TABLE_ROW, propList));
+}
+
+void QXPDrawingRecorder::closeTableRow()
+{
+  m_calls.push_back(Call(Call::CLOSE_TABLE_ROW));
+}
+
+void QXPDrawingRecorder::openTableCell(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_TABLE_CELL, propList));
+}
+
+void QXPDrawingRecorder::closeTableCell()
+{
+  m_calls.push_back(Call(Call::CLOSE_TABLE_CELL));
+}
+
+void QXPDrawingRecorder::insertCoveredTableCell(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::INSERT_COVERED_TABLE_CELL, propList));
+}
+
+void QXPDrawingRecorder::endTableObject()
+{
+  m_calls.push_back(Call(Call::END_TABLE_OBJECT));
+}
+
+void QXPDrawingRecorder::openOrderedListLevel(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_ORDERED_LIST_LEVEL, propList));
+}
+
+void QXPDrawingRecorder::closeOrderedListLevel()
+{
+  m_calls.push_back(Call(Call::CLOSE_ORDERED_LIST_LEVEL));
+}
+
+void QXPDrawingRecorder::openUnorderedListLevel(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_UNORDERED_LIST_LEVEL, propList));
+}
+
+void QXPDrawingRecorder::closeUnorderedListLevel()
+{
+  m_calls.push_back(Call(Call::CLOSE_UNORDERED_LIST_LEVEL));
+}
+
+void QXPDrawingRecorder::openListElement(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_LIST_ELEMENT, propList));
+}
+
+void QXPDrawingRecorder::closeListElement()
+{
+  m_calls.push_back(Call(Call::CLOSE_LIST_ELEMENT));
+}
+
+void QXPDrawingRecorder::defineParagraphStyle(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DEFINE_PARAGRAPH_STYLE, propList));
+}
+
+void QXPDrawingRecorder::openParagraph(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_PARAGRAPH, propList));
+}
+
+void QXPDrawingRecorder::closeParagraph()
+{
+  m_calls.push_back(Call(Call::CLOSE_PARAGRAPH));
+}
+
+void QXPDrawingRecorder::defineCharacterStyle(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::DEFINE_CHARACTER_STYLE, propList));
+}
+
+void QXPDrawingRecorder::openSpan(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_SPAN, propList));
+}
+
+void QXPDrawingRecorder::closeSpan()
+{
+  m_calls.push_back(Call(Call::CLOSE_SPAN));
+}
+
+void QXPDrawingRecorder::openLink(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::OPEN_LINK, propList));
+}
+
+void QXPDrawingRecorder::closeLink()
+{
+  m_calls.push_back(Call(Call::CLOSE_LINK));
+}
+
+void QXPDrawingRecorder::insertTab()
+{
+  m_calls.push_back(Call(Call::INSERT_TAB));
+}
+
+void QXPDrawingRecorder::insertSpace()
+{
+  m_calls.push_back(Call(Call::INSERT_SPACE));
+}
+
+void QXPDrawingRecorder::insertText(const librevenge::RVNGString &text)
+{
+  m_calls.push_back(Call(Call::INSERT_TEXT, text));
+}
+
+void QXPDrawingRecorder::insertLineBreak()
+{
+  m_calls.push_back(Call(Call::INSERT_LINE_BREAK));
+}
+
+void QXPDrawingRecorder::insertField(const librevenge::RVNGPropertyList &propList)
+{
+  m_calls.push_back(Call(Call::INSERT_FIELD, propList));
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
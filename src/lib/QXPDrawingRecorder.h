@@ -0,0 +1,185 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPDRAWINGRECORDER_H_INCLUDED
+#define QXPDRAWINGRECORDER_H_INCLUDED
+
+#include <vector>
+
+#include <librevenge/librevenge.h>
+
+namespace libqxp
+{
+
+/** Drawing interface that records calls, to be replayed later.
+  *
+  * This allows to produce output of several documents concurrently,
+  * while still passing it on in a fixed order.
+  */
+class QXPDrawingRecorder : public librevenge::RVNGDrawingInterface
+{
+  // disable copying
+  QXPDrawingRecorder(const QXPDrawingRecorder &other) = delete;
+  QXPDrawingRecorder &operator=(const QXPDrawingRecorder &other) = delete;
+
+public:
+  QXPDrawingRecorder();
+
+  /** Passes the recorded calls on to @c painter.
+    *
+    * If @c withDocument is false, the calls starting and ending the
+    * document and setting its metadata are left out, so the output
+    * can be embedded in another document.
+    */
+  void replay(librevenge::RVNGDrawingInterface *painter, bool withDocument) const;
+
+  /// Returns how many pages have been recorded up to their end.
+  unsigned completePages() const;
+
+  /** Passes the calls up to the end of the first complete page on
+    * to @c painter and drops them.
+    *
+    * The calls starting and ending the document are left out, like in
+    * replay. Returns false if no page is complete.
+    */
+  bool replayPage(librevenge::RVNGDrawingInterface *painter);
+
+  /// Drops all recorded calls.
+  void clear();
+
+  void startDocument(const librevenge::RVNGPropertyList &propList) override;
+  void endDocument() override;
+  void setDocumentMetaData(const librevenge::RVNGPropertyList &propList) override;
+  void defineEmbeddedFont(const librevenge::RVNGPropertyList &propList) override;
+  void startPage(const librevenge::RVNGPropertyList &propList) override;
+  void endPage() override;
+  void startMasterPage(const librevenge::RVNGPropertyList &propList) override;
+  void endMasterPage() override;
+  void startLayer(const librevenge::RVNGPropertyList &propList) override;
+  void endLayer() override;
+  void startEmbeddedGraphics(const librevenge::RVNGPropertyList &propList) override;
+  void endEmbeddedGraphics() override;
+  void openGroup(const librevenge::RVNGPropertyList &propList) override;
+  void closeGroup() override;
+  void setStyle(const librevenge::RVNGPropertyList &propList) override;
+  void drawRectangle(const librevenge::RVNGPropertyList &propList) override;
+  void drawEllipse(const librevenge::RVNGPropertyList &propList) override;
+  void drawPolygon(const librevenge::RVNGPropertyList &propList) override;
+  void drawPolyline(const librevenge::RVNGPropertyList &propList) override;
+  void drawPath(const librevenge::RVNGPropertyList &propList) override;
+  void drawGraphicObject(const librevenge::RVNGPropertyList &propList) override;
+  void drawConnector(const librevenge::RVNGPropertyList &propList) override;
+  void startTextObject(const librevenge::RVNGPropertyList &propList) override;
+  void endTextObject() override;
+  void startTableObject(const librevenge::RVNGPropertyList &propList) override;
+  void openTableRow(const librevenge::RVNGPropertyList &propList) override;
+  void closeTableRow() override;
+  void openTableCell(const librevenge::RVNGPropertyList &propList) override;
+  void closeTableCell() override;
+  void insertCoveredTableCell(const librevenge::RVNGPropertyList &propList) override;
+  void endTableObject() override;
+  void openOrderedListLevel(const librevenge::RVNGPropertyList &propList) override;
+  void closeOrderedListLevel() override;
+  void openUnorderedListLevel(const librevenge::RVNGPropertyList &propList) override;
+  void closeUnorderedListLevel() override;
+  void openListElement(const librevenge::RVNGPropertyList &propList) override;
+  void closeListElement() override;
+  void defineParagraphStyle(const librevenge::RVNGPropertyList &propList) override;
+  void openParagraph(const librevenge::RVNGPropertyList &propList) override;
+  void closeParagraph() override;
+  void defineCharacterStyle(const librevenge::RVNGPropertyList &propList) override;
+  void openSpan(const librevenge::RVNGPropertyList &propList) override;
+  void closeSpan() override;
+  void openLink(const librevenge::RVNGPropertyList &propList) override;
+  void closeLink() override;
+  void insertTab() override;
+  void insertSpace() override;
+  void insertText(const librevenge::RVNGString &text) override;
+  void insertLineBreak() override;
+  void insertField(const librevenge::RVNGPropertyList &propList) override;
+
+private:
+  struct Call
+  {
+    enum Type
+    {
+      START_DOCUMENT,
+      END_DOCUMENT,
+      SET_DOCUMENT_META_DATA,
+      DEFINE_EMBEDDED_FONT,
+      START_PAGE,
+      END_PAGE,
+      START_MASTER_PAGE,
+      END_MASTER_PAGE,
+      START_LAYER,
+      END_LAYER,
+      START_EMBEDDED_GRAPHICS,
+      END_EMBEDDED_GRAPHICS,
+      OPEN_GROUP,
+      CLOSE_GROUP,
+      SET_STYLE,
+      DRAW_RECTANGLE,
+      DRAW_ELLIPSE,
+      DRAW_POLYGON,
+      DRAW_POLYLINE,
+      DRAW_PATH,
+      DRAW_GRAPHIC_OBJECT,
+      DRAW_CONNECTOR,
+      START_TEXT_OBJECT,
+      END_TEXT_OBJECT,
+      START_TABLE_OBJECT,
+      OPEN_TABLE_ROW,
+      CLOSE_TABLE_ROW,
+      OPEN_TABLE_CELL,
+      CLOSE_TABLE_CELL,
+      INSERT_COVERED_TABLE_CELL,
+      END_TABLE_OBJECT,
+      OPEN_ORDERED_LIST_LEVEL,
+      CLOSE_ORDERED_LIST_LEVEL,
+      OPEN_UNORDERED_LIST_LEVEL,
+      CLOSE_UNORDERED_LIST_LEVEL,
+      OPEN_LIST_ELEMENT,
+      CLOSE_LIST_ELEMENT,
+      DEFINE_PARAGRAPH_STYLE,
+      OPEN_PARAGRAPH,
+      CLOSE_PARAGRAPH,
+      DEFINE_CHARACTER_STYLE,
+      OPEN_SPAN,
+      CLOSE_SPAN,
+      OPEN_LINK,
+      CLOSE_LINK,
+      INSERT_TAB,
+      INSERT_SPACE,
+      INSERT_TEXT,
+      INSERT_LINE_BREAK,
+      INSERT_FIELD
+    };
+
+    explicit Call(Type type_);
+    Call(Type type_, const librevenge::RVNGPropertyList &propList_);
+    Call(Type type_, const librevenge::RVNGString &text_);
+
+    Type type;
+    librevenge::RVNGPropertyList propList;
+    librevenge::RVNGString text;
+  };
+
+  typedef std::vector<Call>::const_iterator CallIterator;
+
+  static void replay(librevenge::RVNGDrawingInterface *painter, CallIterator begin, CallIterator end, bool withDocument);
+
+  std::vector<Call> m_calls;
+  unsigned m_completePages;
+};
+
+}
+
+#endif // QXPDRAWINGRECORDER_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,243 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libqxp/QXPFileStream.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+namespace libqxp
+{
+
+namespace
+{
+
+// most reads are small, so the file is read in bigger pieces
+const unsigned long READ_BUFFER_LENGTH = 65536;
+
+}
+
+struct QXPFileStream::Impl
+{
+  explicit Impl(const char *filename);
+  ~Impl();
+
+  // reads up to length bytes from offset to the buffer
+  void fill(long offset, unsigned long length);
+  librevenge::RVNGInputStream &structured();
+
+  const std::string filename;
+  int fd;
+  long length;
+  long pos;
+  std::vector<unsigned char> buffer;
+  long bufferOffset;
+  // opened only if the structure is asked for
+  std::unique_ptr<librevenge::RVNGFileStream> structuredStream;
+};
+
+QXPFileStream::Impl::Impl(const char *const filename_)
+  : filename(filename_ ? filename_ : "")
+  , fd(-1)
+  , length(0)
+  , pos(0)
+  , buffer()
+  , bufferOffset(0)
+  , structuredStream()
+{
+  if (!filename_)
+    return;
+  fd = open(filename_, O_RDONLY | O_BINARY);
+  if (fd < 0)
+    return;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode))
+  {
+    close(fd);
+    fd = -1;
+    return;
+  }
+  length = long(info.st_size);
+}
+
+QXPFileStream::Impl::~Impl()
+{
+  if (fd >= 0)
+    close(fd);
+}
+
+void QXPFileStream::Impl::fill(const long offset, const unsigned long length_)
+{
+  buffer.resize(length_);
+  bufferOffset = offset;
+  if (lseek(fd, off_t(offset), SEEK_SET) != off_t(offset))
+  {
+    buffer.clear();
+    return;
+  }
+  unsigned long done = 0;
+  while (done < length_)
+  {
+    const ssize_t bytes = ::read(fd, buffer.data() + done, length_ - done);
+    if (bytes < 0 && errno == EINTR)
+      continue;
+    if (bytes <= 0)
+      break;
+    done += static_cast<unsigned long>(bytes);
+  }
+  buffer.resize(done);
+}
+
+librevenge::RVNGInputStream &QXPFileStream::Impl::structured()
+{
+  if (!structuredStream)
+    structuredStream.reset(new librevenge::RVNGFileStream(filename.c_str()));
+  return *structuredStream;
+}
+
+QXPFileStream::QXPFileStream(const char *const filename)
+  : m_impl(new Impl(filename))
+{
+}
+
+QXPFileStream::~QXPFileStream()
+{
+}
+
+bool QXPFileStream::isStructured()
+{
+  if (m_impl->fd < 0)
+    return false;
+  return m_impl->structured().isStructured();
+}
+
+unsigned QXPFileStream::subStreamCount()
+{
+  if (m_impl->fd < 0)
+    return 0;
+  return m_impl->structured().subStreamCount();
+}
+
+const char *QXPFileStream::subStreamName(const unsigned id)
+{
+  if (m_impl->fd < 0)
+    return 0;
+  return m_impl->structured().subStreamName(id);
+}
+
+bool QXPFileStream::existsSubStream(const char *const name)
+{
+  if (m_impl->fd < 0)
+    return false;
+  return m_impl->structured().existsSubStream(name);
+}
+
+librevenge::RVNGInputStream *QXPFileStream::getSubStreamByName(const char *const name)
+{
+  if (m_impl->fd < 0)
+    return 0;
+  return m_impl->structured().getSubStreamByName(name);
+}
+
+librevenge::RVNGInputStream *QXPFileStream::getSubStreamById(const unsigned id)
+{
+  if (m_impl->fd < 0)
+    return 0;
+  return m_impl->structured().getSubStreamById(id);
+}
+
+const unsigned char *QXPFileStream::read(unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+
+  if (m_impl->fd < 0 || numBytes == 0 || m_impl->pos >= m_impl->length)
+    return 0;
+
+  numBytes = std::min(numBytes, static_cast<unsigned long>(m_impl->length - m_impl->pos));
+
+  const long bufferEnd = m_impl->bufferOffset + long(m_impl->buffer.size());
+  if (m_impl->pos < m_impl->bufferOffset || m_impl->pos + long(numBytes) > bufferEnd)
+  {
+    const unsigned long length = std::min(std::max(numBytes, READ_BUFFER_LENGTH), static_cast<unsigned long>(m_impl->length - m_impl->pos));
+    m_impl->fill(m_impl->pos, length);
+    // the file may have been truncated since it was opened
+    numBytes = std::min(numBytes, static_cast<unsigned long>(m_impl->buffer.size()));
+    if (numBytes == 0)
+      return 0;
+  }
+
+  const unsigned char *const data = m_impl->buffer.data() + (m_impl->pos - m_impl->bufferOffset);
+  m_impl->pos += long(numBytes);
+  numBytesRead = numBytes;
+  return data;
+}
+catch (...)
+{
+  return 0;
+}
+
+int QXPFileStream::seek(const long offset, const librevenge::RVNG_SEEK_TYPE seekType)
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + m_impl->pos;
+    break;
+  case librevenge::RVNG_SEEK_END :
+    pos = offset + m_impl->length;
+    break;
+  default :
+    return -1;
+  }
+
+  if ((pos < 0) || (pos > m_impl->length))
+    return 1;
+
+  m_impl->pos = pos;
+  return 0;
+}
+
+long QXPFileStream::tell()
+{
+  return m_impl->pos;
+}
+
+bool QXPFileStream::isEnd()
+{
+  return m_impl->pos >= m_impl->length;
+}
+
+void QXPFileStream::willNeed(const unsigned long offset, const unsigned long length) const
+{
+#ifdef POSIX_FADV_WILLNEED
+  if (m_impl->fd >= 0 && length > 0)
+    posix_fadvise(m_impl->fd, off_t(offset), off_t(length), POSIX_FADV_WILLNEED);
+#else
+  (void) offset;
+  (void) length;
+#endif
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -59,6 +59,15 @@ public:
   unsigned version() const;
   const char *encoding() const;
 
+  virtual unsigned pagesCount() const
+  {
+    return 0;
+  }
+  virtual unsigned masterPagesCount() const
+  {
+    return 0;
+  }
+
 protected:
   unsigned m_proc;
   unsigned m_version;
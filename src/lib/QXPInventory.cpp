@@ -0,0 +1,31 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libqxp/QXPInventory.h>
+
+namespace libqxp
+{
+
+QXPInventory::QXPInventory()
+  : version(0)
+  , pageCount(0)
+  , pageWidth(0)
+  , pageHeight(0)
+  , fonts()
+  , colors()
+  , pictureCount(0)
+  , pictureBytes(0)
+  , storyCount(0)
+  , characterCount(0)
+{
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
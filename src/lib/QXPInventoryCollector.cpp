@@ -0,0 +1,85 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPInventoryCollector.h"
+
+#include <libqxp/QXPInventory.h>
+
+#include "QXPTypes.h"
+
+namespace libqxp
+{
+
+QXPInventoryCollector::QXPInventoryCollector(QXPInventory &inventory)
+  : m_inventory(inventory)
+  , m_pictures()
+  , m_texts()
+  , m_fonts()
+{
+}
+
+ContentNeeds QXPInventoryCollector::pictureNeeds() const
+{
+  return ContentNeeds::SIZE;
+}
+
+ContentNeeds QXPInventoryCollector::textNeeds() const
+{
+  return ContentNeeds::SIZE;
+}
+
+void QXPInventoryCollector::startPage(const Page &page)
+{
+  if (m_inventory.pageCount == 0 && !page.pageSettings.empty())
+  {
+    m_inventory.pageWidth = page.pageSettings[0].offset.width();
+    m_inventory.pageHeight = page.pageSettings[0].offset.height();
+  }
+  m_inventory.pageCount += unsigned(page.pageSettings.size());
+}
+
+void QXPInventoryCollector::collectColors(const std::map<unsigned, Color> &colors)
+{
+  m_inventory.colors.clear();
+  for (const auto &color : colors)
+    m_inventory.colors.append(color.second.toString());
+}
+
+void QXPInventoryCollector::collectPictureSize(const unsigned index, const unsigned long size)
+{
+  // the same picture may be referred to more than once
+  if (m_pictures.insert(index).second)
+  {
+    ++m_inventory.pictureCount;
+    m_inventory.pictureBytes += size;
+  }
+}
+
+void QXPInventoryCollector::collectTextLength(const std::shared_ptr<Text> &runs, const unsigned linkId, const unsigned long length)
+{
+  if (m_texts.insert(linkId).second)
+  {
+    ++m_inventory.storyCount;
+    m_inventory.characterCount += length;
+    // only the formats the text refers to, not all those defined in the document
+    if (runs && runs->formats)
+    {
+      for (size_t run = 0; run != runs->charFormats.size(); ++run)
+      {
+        const auto &fontName = runs->charFormat(run).fontName;
+        if (runs->charFormats.length(run) > 0 && m_fonts.insert(fontName.cstr()).second)
+          m_inventory.fonts.append(fontName);
+      }
+    }
+  }
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,54 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPINVENTORYCOLLECTOR_H_INCLUDED
+#define QXPINVENTORYCOLLECTOR_H_INCLUDED
+
+#include "QXPCollector.h"
+
+#include <set>
+#include <string>
+
+namespace libqxp
+{
+
+class QXPInventory;
+
+// Gathers a summary of the document, only asking for sizes of pictures and texts.
+class QXPInventoryCollector : public QXPCollector
+{
+  // disable copying
+  QXPInventoryCollector(const QXPInventoryCollector &other) = delete;
+  QXPInventoryCollector &operator=(const QXPInventoryCollector &other) = delete;
+
+public:
+  explicit QXPInventoryCollector(QXPInventory &inventory);
+
+  ContentNeeds pictureNeeds() const override;
+  ContentNeeds textNeeds() const override;
+
+  void startPage(const Page &page) override;
+
+  void collectColors(const std::map<unsigned, Color> &colors) override;
+
+  void collectPictureSize(unsigned index, unsigned long size) override;
+  void collectTextLength(const std::shared_ptr<Text> &runs, unsigned linkId, unsigned long length) override;
+
+private:
+  QXPInventory &m_inventory;
+  std::set<unsigned> m_pictures;
+  std::set<unsigned> m_texts;
+  std::set<std::string> m_fonts;
+};
+
+}
+
+#endif // QXPINVENTORYCOLLECTOR_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -12,10 +12,11 @@
 #include <cmath>
 #include <cstring>
 #include <limits>
-#include <map>
 #include <vector>
 
 #include "QXPMemoryStream.h"
+#include "QXPSubStream.h"
+#include "QXPZipStream.h"
 #include "libqxp_utils.h"
 
 namespace libqxp
@@ -36,8 +37,9 @@ public:
   /*!\brief creates a stream with given endian
    * \param input the given input
    * \param inverted must be set to true for pc doc and ole part and to false for mac doc
+   * \param checkCompression if true, unwraps zip, BinHex and MacMIME encoded input
    */
-  MWAWInputStream(std::shared_ptr<librevenge::RVNGInputStream> input, bool inverted);
+  MWAWInputStream(std::shared_ptr<librevenge::RVNGInputStream> input, bool inverted, bool checkCompression=false);
 
   /*!\brief creates a stream with given endian from an existing input
    *
@@ -193,6 +195,11 @@ public:
   {
     return m_resourceFork;
   }
+  /** returns the container the data fork has been extracted from */
+  QXPDocument::Wrapper getWrapper() const
+  {
+    return m_wrapper;
+  }
 
 
 protected:
@@ -205,6 +212,8 @@ protected:
   bool unBinHex();
   //! unzip the data in the file is a zip file of a mac file
   bool unzipStream();
+  //! returns a member of the zip file in the data fork
+  std::shared_ptr<librevenge::RVNGInputStream> getZipMember(const std::string &name);
   //! check if some stream are in MacMIME format, if so de MacMIME
   bool unMacMIME();
   //! de MacMIME an input stream
@@ -213,6 +222,14 @@ protected:
                  std::shared_ptr<librevenge::RVNGInputStream> &rsrcInput) const;
   //! check if a stream is an internal merge stream
   bool unsplitInternalMergeStream();
+  //! replaces the input by its data fork if it is a known container
+  void unwrap();
+  //! records the container, unless an outer one is already known
+  void setWrapper(QXPDocument::Wrapper wrapper)
+  {
+    if (m_wrapper == QXPDocument::WRAPPER_NONE)
+      m_wrapper = wrapper;
+  }
 
 private:
   MWAWInputStream(MWAWInputStream const &orig) = delete;
@@ -235,38 +252,51 @@ protected:
   mutable std::string m_fInfoCreator;
   //! the resource fork
   std::shared_ptr<MWAWInputStream> m_resourceFork;
+  //! the container the data fork has been extracted from
+  QXPDocument::Wrapper m_wrapper;
   //! big or normal endian
   bool m_inverseRead;
 };
 
-MWAWInputStream::MWAWInputStream(std::shared_ptr<librevenge::RVNGInputStream> inp, bool inverted)
+MWAWInputStream::MWAWInputStream(std::shared_ptr<librevenge::RVNGInputStream> inp, bool inverted, bool checkCompression)
   : m_stream(inp), m_streamSize(0), m_readLimit(-1), m_prevLimits(),
-    m_fInfoType(""), m_fInfoCreator(""), m_resourceFork(), m_inverseRead(inverted)
+    m_fInfoType(""), m_fInfoCreator(""), m_resourceFork(), m_wrapper(QXPDocument::WRAPPER_NONE), m_inverseRead(inverted)
 {
   updateStreamSize();
+  if (m_stream && checkCompression)
+    unwrap();
 }
 
 MWAWInputStream::MWAWInputStream(librevenge::RVNGInputStream *inp, bool inverted, bool checkCompression)
   : m_stream(), m_streamSize(0), m_readLimit(-1), m_prevLimits(),
-    m_fInfoType(""), m_fInfoCreator(""), m_resourceFork(), m_inverseRead(inverted)
+    m_fInfoType(""), m_fInfoCreator(""), m_resourceFork(), m_wrapper(QXPDocument::WRAPPER_NONE), m_inverseRead(inverted)
 {
   if (!inp) return;
 
   m_stream = std::shared_ptr<librevenge::RVNGInputStream>(inp, QXPDummyDeleter());
   updateStreamSize();
-  if (!checkCompression)
-    return;
+  if (checkCompression)
+    unwrap();
+}
 
+void MWAWInputStream::unwrap()
+{
   // first check if the file is "local" structure one
   if (unsplitInternalMergeStream())
     updateStreamSize();
   // then check the zip format
   if (unzipStream())
+  {
     updateStreamSize();
+    setWrapper(QXPDocument::WRAPPER_ZIP);
+  }
 
   // then check if the data are in binhex format
   if (unBinHex())
+  {
     updateStreamSize();
+    setWrapper(QXPDocument::WRAPPER_BINHEX);
+  }
 
   // now check for MacMIME format in m_stream or in m_resourceFork
   if (unMacMIME())
@@ -590,6 +620,108 @@ bool MWAWInputStream::readDoubleReverted8(double &res, bool &isNotANumber)
 // BinHex 4.0
 //
 ////////////////////////////////////////////////////////////
+namespace
+{
+
+//! 6-bit value of each BinHex 4.0 character, -1 for characters outside of the alphabet
+const signed char BINHEX_DECODE[256] =
+{
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, -1, -1,
+  13, 14, 15, 16, 17, 18, 19, -1, 20, 21, -1, -1, -1, -1, -1, -1,
+  22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, -1,
+  37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46, 47, -1, -1, -1, -1,
+  48, 49, 50, 51, 52, 53, 54, -1, 55, 56, 57, 58, 59, 60, -1, -1,
+  61, 62, 63, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+//! size of the chunks the encoded data are read by
+const unsigned long BINHEX_CHUNK_SIZE = 0x10000;
+
+/*! \brief undoes the run-length encoding of BinHex 4.0
+ *
+ * A 0x90 byte is followed by a count: 0 stands for a literal 0x90,
+ * any other count repeats the previous byte up to count times.
+ */
+class BinHexRLEDecoder
+{
+  // disable copying
+  BinHexRLEDecoder(const BinHexRLEDecoder &other) = delete;
+  BinHexRLEDecoder &operator=(const BinHexRLEDecoder &other) = delete;
+
+public:
+  explicit BinHexRLEDecoder(std::vector<unsigned char> &output)
+    : m_output(output)
+    , m_repeat(false)
+  {
+  }
+
+  //! appends a decoded byte, returns false if the data are corrupted
+  bool put(const unsigned value)
+  {
+    if (!m_repeat)
+    {
+      if (value == 0x90)
+        m_repeat = true;
+      else
+        m_output.push_back(static_cast<unsigned char>(value));
+      return true;
+    }
+
+    m_repeat = false;
+    if (value == 1 || value == 2)
+    {
+      QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find bad value after repetitif character\n"));
+      return false;
+    }
+    if (value == 0)
+    {
+      m_output.push_back(0x90);
+      return true;
+    }
+    if (m_output.empty())
+    {
+      QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find repetitif character in the first position\n"));
+      return false;
+    }
+    const unsigned char last = m_output.back();
+    m_output.insert(m_output.end(), value - 1, last);
+    return true;
+  }
+
+  //! returns false if the data end in the middle of a repetition
+  bool finish() const
+  {
+    if (m_repeat)
+    {
+      QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find repetitif character in the last position\n"));
+      return false;
+    }
+    return true;
+  }
+
+private:
+  std::vector<unsigned char> &m_output;
+  bool m_repeat;
+};
+
+unsigned long readBE32(const unsigned char *const data)
+{
+  return (static_cast<unsigned long>(data[0]) << 24) | (static_cast<unsigned long>(data[1]) << 16)
+         | (static_cast<unsigned long>(data[2]) << 8) | static_cast<unsigned long>(data[3]);
+}
+
+}
+
 bool MWAWInputStream::unBinHex()
 {
   if (!hasDataFork() || size() < 45)
@@ -616,124 +748,108 @@ bool MWAWInputStream::unBinHex()
   if (isEnd() || !numEOL || (char(readLong(1)))!= ':')
     return false;
 
-  // first phase reconstruct the file
-  static char const binChar[65] = "!\"#$%&'()*+,-012345689@ABCDEFGHIJKLMNPQRSTUVXYZ[`abcdefhijklmpqr";
-  std::map<unsigned char, int>  binMap;
-  for (int i = 0; i < 64; i++) binMap[static_cast<unsigned char>(binChar[i])]=i;
+  // first phase reconstruct the file: every 4 characters give 3 bytes
+  std::vector<unsigned char> content;
+  content.reserve(static_cast<size_t>(size() - tell()) / 4 * 3);
+  BinHexRLEDecoder rle(content);
   bool endData = false;
-  int numActByte = 0, actVal = 0;
-  librevenge::RVNGBinaryData content;
-  bool findRepetitif = false;
-  while (1)
+  int numActByte = 0;
+  unsigned actVal = 0;
+  while (!endData)
   {
-    if (isEnd())
+    unsigned long numRead = 0;
+    const unsigned char *const chunk = read(BINHEX_CHUNK_SIZE, numRead);
+    if (!chunk || numRead == 0)
     {
       QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: do not find ending ':' character\n"));
       return false;
     }
-    unsigned char c = static_cast<unsigned char>(readLong(1));
-    if (c == '\n') continue;
-    int readVal = 0;
-    if (c == ':')
-      endData = true;
-    else if (binMap.find(c) == binMap.end())
-    {
-      QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find unexpected char when decoding file\n"));
-      return false;
-    }
-    else
-      readVal = binMap.find(c)->second;
-    int wVal = -1;
-    if (numActByte==0)
-      actVal |= (readVal<<2);
-    else if (numActByte==2)
-    {
-      wVal = (actVal | readVal);
-      actVal = 0;
-    }
-    else if (numActByte==4)
-    {
-      wVal = actVal | ((readVal>>2)&0xF);
-      actVal = (readVal&0x3)<<6;
-    }
-    else if (numActByte==6)
+    for (unsigned long i = 0; i < numRead && !endData; ++i)
     {
-      wVal = actVal | ((readVal>>4)&0x3);
-      actVal = (readVal&0xf)<<4;
-    }
-    numActByte = (numActByte+6)%8;
-
-    int maxToWrite = (endData&&actVal) ? 2 : 1;
-    for (int wPos = 0; wPos < maxToWrite; wPos++)
-    {
-      int value = wPos ? actVal : wVal;
-      if (value == -1) continue;
-      if (!findRepetitif && value != 0x90)
+      if (numActByte == 0 && i + 4 <= numRead)
       {
-        content.append(static_cast<unsigned char>(value));
-        continue;
-      }
-      if (value == 0x90 && !findRepetitif)
-      {
-        findRepetitif = true;
-        continue;
+        // fast path: a whole group of 4 characters
+        const int v0 = BINHEX_DECODE[chunk[i]];
+        const int v1 = BINHEX_DECODE[chunk[i + 1]];
+        const int v2 = BINHEX_DECODE[chunk[i + 2]];
+        const int v3 = BINHEX_DECODE[chunk[i + 3]];
+        if ((v0 | v1 | v2 | v3) >= 0)
+        {
+          if (!rle.put(unsigned((v0 << 2) | (v1 >> 4)))
+              || !rle.put(unsigned(((v1 & 0xf) << 4) | (v2 >> 2)))
+              || !rle.put(unsigned(((v2 & 0x3) << 6) | v3)))
+            return false;
+          i += 3;
+          continue;
+        }
       }
 
-      if (value == 1 || value == 2)
+      const unsigned char c = chunk[i];
+      if (c == '\n') continue;
+      unsigned readVal = 0;
+      if (c == ':')
+        endData = true;
+      else if (BINHEX_DECODE[c] < 0)
       {
-        QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find bad value after repetitif character\n"));
+        QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find unexpected char when decoding file\n"));
         return false;
       }
-      findRepetitif = false;
-      if (value == 0)
+      else
+        readVal = unsigned(BINHEX_DECODE[c]);
+      int wVal = -1;
+      if (numActByte==0)
+        actVal |= (readVal<<2);
+      else if (numActByte==2)
       {
-        content.append(0x90);
-        continue;
+        wVal = int(actVal | readVal);
+        actVal = 0;
       }
-      if (content.size()==0)
+      else if (numActByte==4)
       {
-        QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find repetitif character in the first position\n"));
-        return false;
+        wVal = int(actVal | ((readVal>>2)&0xF));
+        actVal = (readVal&0x3)<<6;
       }
-      unsigned char lChar = content.getDataBuffer()[content.size()-1];
-      for (int i = 0; i < value-1; i++)
-        content.append(lChar);
-      continue;
+      else if (numActByte==6)
+      {
+        wVal = int(actVal | ((readVal>>4)&0x3));
+        actVal = (readVal&0xf)<<4;
+      }
+      numActByte = (numActByte+6)%8;
+
+      if (wVal != -1 && !rle.put(unsigned(wVal)))
+        return false;
+      if (endData && actVal && !rle.put(actVal))
+        return false;
     }
-    if (endData) break;
   }
-  if (findRepetitif)
-  {
-    QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: find repetitif character in the last position\n"));
+  if (!rle.finish())
     return false;
-  }
-  long contentSize=long(content.size());
+  const long contentSize=long(content.size());
   if (contentSize < 27)
   {
     QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: the content file is too small\n"));
     return false;
   }
-  librevenge::RVNGInputStream *contentInput=const_cast<librevenge::RVNGInputStream *>(content.getDataStream());
-  int fileLength = static_cast<int>(readU8(contentInput));
-  if (fileLength < 1 || fileLength > 64 || long(fileLength+21) > contentSize)
+  const unsigned char *const data = content.data();
+  const long fileLength = long(data[0]);
+  // name length, name, version, type, creator, flags, data and rsrc lengths
+  long pos = 1 + fileLength + 1 + 8 + 2 + 8;
+  if (fileLength < 1 || fileLength > 64 || pos + 2 > contentSize)
   {
     QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: the file name size seems odd\n"));
     return false;
   }
-  contentInput->seek(fileLength+1, librevenge::RVNG_SEEK_CUR); // filename + version
   // creator, type
   std::string type(""), creator("");
-  for (int p = 0; p < 4; p++)
+  for (long p = fileLength + 2; p < fileLength + 6; p++)
   {
-    char c = char(readU8(contentInput));
-    if (c)
-      type += c;
+    if (data[p])
+      type += char(data[p]);
   }
-  for (int p = 0; p < 4; p++)
+  for (long p = fileLength + 6; p < fileLength + 10; p++)
   {
-    char c = char(readU8(contentInput));
-    if (c)
-      creator += c;
+    if (data[p])
+      creator += char(data[p]);
   }
   if (creator.length()==4 && type.length()==4)
   {
@@ -744,12 +860,12 @@ bool MWAWInputStream::unBinHex()
   {
     QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: the file name size seems odd\n"));
   }
-  contentInput->seek(2, librevenge::RVNG_SEEK_CUR); // skip flags
-  long dataLength = long(readULong(contentInput, 4, 0, false));
-  long rsrcLength = long(readULong(contentInput, 4, 0, false));
-  long pos = contentInput->tell()+2; // skip CRC
-  if (dataLength<0 || rsrcLength < 0 || (dataLength==0 && rsrcLength==0) ||
-      pos+dataLength+rsrcLength+4 > contentSize)
+  const unsigned long dataLength = readBE32(data + fileLength + 12);
+  const unsigned long rsrcLength = readBE32(data + fileLength + 16);
+  pos += 2; // skip CRC
+  if ((dataLength==0 && rsrcLength==0) || dataLength > unsigned(std::numeric_limits<int>::max()) ||
+      rsrcLength > unsigned(std::numeric_limits<int>::max()) ||
+      pos+long(dataLength)+long(rsrcLength)+4 > contentSize)
   {
     QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: the data/rsrc fork size seems odd\n"));
     return false;
@@ -761,35 +877,13 @@ bool MWAWInputStream::unBinHex()
   }
   else if (rsrcLength)
   {
-    contentInput->seek(pos+dataLength+2, librevenge::RVNG_SEEK_SET);
-    unsigned long numBytesRead = 0;
-    const unsigned char *data =
-      contentInput->read(static_cast<unsigned long>(rsrcLength), numBytesRead);
-    if (numBytesRead != static_cast<unsigned long>(rsrcLength) || !data)
-    {
-      QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: can not read the resource fork\n"));
-    }
-    else
-    {
-      std::shared_ptr<librevenge::RVNGInputStream> rsrc(new QXPMemoryStream(data, static_cast<unsigned int>(numBytesRead)));
-      m_resourceFork.reset(new MWAWInputStream(rsrc, false));
-    }
+    std::shared_ptr<librevenge::RVNGInputStream> rsrc(new QXPMemoryStream(data + pos + long(dataLength) + 2, static_cast<unsigned int>(rsrcLength)));
+    m_resourceFork.reset(new MWAWInputStream(rsrc, false));
   }
   if (!dataLength)
     m_stream.reset();
   else
-  {
-    contentInput->seek(pos, librevenge::RVNG_SEEK_SET);
-    unsigned long numBytesRead = 0;
-    const unsigned char *data =
-      contentInput->read(static_cast<unsigned long>(dataLength), numBytesRead);
-    if (numBytesRead != static_cast<unsigned long>(dataLength) || !data)
-    {
-      QXP_DEBUG_MSG(("MWAWInputStream::unBinHex: can not read the data fork\n"));
-      return false;
-    }
-    m_stream.reset(new QXPMemoryStream(data, static_cast<unsigned int>(numBytesRead)));
-  }
+    m_stream.reset(new QXPMemoryStream(data + pos, static_cast<unsigned int>(dataLength)));
 
   return true;
 }
@@ -813,6 +907,7 @@ bool MWAWInputStream::unsplitInternalMergeStream()
       if (newRsrcFork)   // rsrcinfo must be a MacMIME file, it can not be empty
       {
         m_stream.reset(m_stream->getSubStreamByName("DataFork")); // empty data fork is rare, but possible
+        setWrapper(QXPDocument::WRAPPER_FORKS);
         m_resourceFork.reset(new MWAWInputStream(newRsrcFork, m_inverseRead)); // rsrcinfo will be decoded by unMacMIME
       }
       else
@@ -827,6 +922,7 @@ bool MWAWInputStream::unsplitInternalMergeStream()
       {
         std::shared_ptr<librevenge::RVNGInputStream> newInfo(m_stream->getSubStreamByName("InfoFork"));
         m_stream.reset(m_stream->getSubStreamByName("DataFork"));
+        setWrapper(QXPDocument::WRAPPER_FORKS);
         m_resourceFork.reset(new MWAWInputStream(newRsrcFork, m_inverseRead));
         // we must decode the information here
         unsigned long numBytesRead = 0;
@@ -902,7 +998,7 @@ bool MWAWInputStream::unzipStream()
   if (names.size() == 1)
   {
     // ok as the OLE file must have at least MN and MN0 OLE
-    m_stream.reset(m_stream->getSubStreamByName(names[0].c_str()));
+    m_stream = getZipMember(names[0]);
     return true;
   }
   if (names.size() != 2)
@@ -922,12 +1018,21 @@ bool MWAWInputStream::unzipStream()
     prefix = "__MACOSX/._";
   prefix += names[0];
   if (prefix != names[1]) return false;
-  std::shared_ptr<librevenge::RVNGInputStream> rsrcPtr(m_stream->getSubStreamByName(names[1].c_str()));
+  std::shared_ptr<librevenge::RVNGInputStream> rsrcPtr(getZipMember(names[1]));
   m_resourceFork.reset(new MWAWInputStream(rsrcPtr, false));
-  m_stream.reset(m_stream->getSubStreamByName(names[0].c_str()));
+  m_stream = getZipMember(names[0]);
   return true;
 }
 
+std::shared_ptr<librevenge::RVNGInputStream> MWAWInputStream::getZipMember(const std::string &name)
+{
+  // prefer inflating on demand, so big members are not held in memory as a whole
+  std::shared_ptr<librevenge::RVNGInputStream> member = QXPZipStream::open(m_stream, name.c_str());
+  if (!member)
+    member.reset(m_stream->getSubStreamByName(name.c_str()));
+  return member;
+}
+
 ////////////////////////////////////////////////////////////
 //
 // MacMIME part
@@ -960,6 +1065,7 @@ bool MWAWInputStream::unMacMIME()
     }
     if (ok)
     {
+      setWrapper(QXPDocument::WRAPPER_MACMIME);
       m_stream = newDataInput;
       if (newRsrcInput)
       {
@@ -985,6 +1091,9 @@ bool MWAWInputStream::unMacMIME(MWAWInputStream *inp,
   rsrcInput.reset();
   if (!inp || !inp->hasDataFork() || inp->size()<26) return false;
 
+  // the finder info is only kept if all entries are valid
+  std::string fInfoType, fInfoCreator;
+
   try
   {
     inp->seek(0, librevenge::RVNG_SEEK_SET);
@@ -999,7 +1108,7 @@ bool MWAWInputStream::unMacMIME(MWAWInputStream *inp,
     }
     inp->seek(16, librevenge::RVNG_SEEK_CUR); // filename
     long numEntries = long(inp->readULong(2));
-    if (inp->checkPosition(inp->tell() + 12 * numEntries)) // minimal sanity check
+    if (!inp->checkPosition(inp->tell() + 12 * numEntries)) // minimal sanity check
       numEntries = (inp->size() - inp->tell()) / 12;
     if (inp->isEnd() || numEntries == 0)
     {
@@ -1041,6 +1150,22 @@ bool MWAWInputStream::unMacMIME(MWAWInputStream *inp,
         QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: find bad entry pos\n"));
         return false;
       }
+      if (wh != 9)
+      {
+        // the forks are stored as they are, so just point into the input
+        if (!inp->checkPosition(entryPos + long(entrySize)))
+        {
+          QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: %s entry is too long\n", what[wh]));
+          return false;
+        }
+        std::shared_ptr<librevenge::RVNGInputStream> fork(new QXPSubStream(inp->input(), static_cast<unsigned long>(entryPos), entrySize));
+        if (wh==1)
+          dataInput = fork;
+        else
+          rsrcInput = fork;
+        inp->seek(pos+12, librevenge::RVNG_SEEK_SET);
+        continue;
+      }
       /* try to read the data */
       if (inp->seek(entryPos, librevenge::RVNG_SEEK_SET) != 0)
       {
@@ -1054,47 +1179,41 @@ bool MWAWInputStream::unMacMIME(MWAWInputStream *inp,
         QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: can not read %lX byte\n", static_cast<long unsigned int>(entryPos)));
         return false;
       }
-      if (wh==1)
-        dataInput.reset(new QXPMemoryStream(data, static_cast<unsigned int>(numBytesRead)));
-      else if (wh==2)
-        rsrcInput.reset(new QXPMemoryStream(data, static_cast<unsigned int>(numBytesRead)));
-      else   // the finder info
+      // the finder info
+      if (entrySize < 8)
       {
-        if (entrySize < 8)
-        {
-          QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: finder info size is odd\n"));
-        }
-        else
+        QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: finder info size is odd\n"));
+      }
+      else
+      {
+        bool ok = true;
+        std::string type(""), creator("");
+        for (int p = 0; p < 4; p++)
         {
-          bool ok = true;
-          std::string type(""), creator("");
-          for (int p = 0; p < 4; p++)
-          {
-            if (!data[p])
-            {
-              ok = false;
-              break;
-            }
-            type += char(data[p]);
-          }
-          for (int p = 4; ok && p < 8; p++)
-          {
-            if (!data[p])
-            {
-              ok = false;
-              break;
-            }
-            creator += char(data[p]);
-          }
-          if (ok)
+          if (!data[p])
           {
-            m_fInfoType = type;
-            m_fInfoCreator = creator;
+            ok = false;
+            break;
           }
-          else if (type.length())
+          type += char(data[p]);
+        }
+        for (int p = 4; ok && p < 8; p++)
+        {
+          if (!data[p])
           {
-            QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: can not read find info\n"));
+            ok = false;
+            break;
           }
+          creator += char(data[p]);
+        }
+        if (ok)
+        {
+          fInfoType = type;
+          fInfoCreator = creator;
+        }
+        else if (type.length())
+        {
+          QXP_DEBUG_MSG(("MWAWInputStream::unMacMIME: can not read find info\n"));
         }
       }
 
@@ -1105,6 +1224,11 @@ bool MWAWInputStream::unMacMIME(MWAWInputStream *inp,
   {
     return false;
   }
+  if (!fInfoType.empty())
+  {
+    m_fInfoType = fInfoType;
+    m_fInfoCreator = fInfoCreator;
+  }
   return true;
 }
 
@@ -1234,16 +1358,23 @@ QXPMacFileParser::QXPMacFileParser(std::shared_ptr<librevenge::RVNGInputStream>
   : m_dataFork(dataFork)
   , m_type(type)
   , m_creator(creator)
+  , m_wrapper(QXPDocument::WRAPPER_NONE)
 {
 }
 
 bool QXPMacFileParser::parse(const std::shared_ptr<librevenge::RVNGInputStream> &input)
 {
-  MWAWInputStream strm(input.get(), false, true);
+  MWAWInputStream strm(input, false, true);
   m_dataFork = strm.input();
+  m_wrapper = strm.getWrapper();
   return strm.hasDataFork() && strm.getFinderInfo(m_type, m_creator);
 }
 
+QXPDocument::Wrapper QXPMacFileParser::wrapper() const
+{
+  return m_wrapper;
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -15,6 +15,8 @@
 
 #include <librevenge-stream/librevenge-stream.h>
 
+#include <libqxp/libqxp.h>
+
 namespace libqxp
 {
 
@@ -25,10 +27,14 @@ public:
 
   bool parse(const std::shared_ptr<librevenge::RVNGInputStream> &input);
 
+  // the container the data fork has been extracted from
+  QXPDocument::Wrapper wrapper() const;
+
 private:
   std::shared_ptr<librevenge::RVNGInputStream> &m_dataFork;
   std::string &m_type;
   std::string &m_creator;
+  QXPDocument::Wrapper m_wrapper;
 };
 
 }
@@ -0,0 +1,121 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libqxp/QXPMemoryStats.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace libqxp
+{
+
+namespace
+{
+
+void decrease(QXPMemoryStats::Usage &usage, const unsigned long size)
+{
+  usage.current -= std::min(usage.current, size);
+}
+
+void increase(QXPMemoryStats::Usage &usage, const unsigned long size)
+{
+  usage.current += size;
+  usage.peak = std::max(usage.peak, usage.current);
+}
+
+}
+
+struct QXPMemoryStats::Impl
+{
+  Impl()
+    : mutex()
+    , usage()
+    , total()
+  {
+  }
+
+  // background tasks account for their buffers too
+  std::mutex mutex;
+  Usage usage[CATEGORY_COUNT];
+  Usage total;
+};
+
+QXPMemoryStats::QXPMemoryStats()
+  : m_impl(new Impl())
+{
+}
+
+QXPMemoryStats::~QXPMemoryStats()
+{
+}
+
+void QXPMemoryStats::clear()
+{
+  std::lock_guard<std::mutex> lock(m_impl->mutex);
+  for (auto &usage : m_impl->usage)
+    usage = Usage{0, 0};
+  m_impl->total = Usage{0, 0};
+}
+
+void QXPMemoryStats::allocate(const Category category, const unsigned long size)
+{
+  if (category >= CATEGORY_COUNT)
+    return;
+  std::lock_guard<std::mutex> lock(m_impl->mutex);
+  increase(m_impl->usage[category], size);
+  increase(m_impl->total, size);
+}
+
+void QXPMemoryStats::release(const Category category, const unsigned long size)
+{
+  if (category >= CATEGORY_COUNT)
+    return;
+  std::lock_guard<std::mutex> lock(m_impl->mutex);
+  const unsigned long released = std::min(m_impl->usage[category].current, size);
+  decrease(m_impl->usage[category], released);
+  decrease(m_impl->total, released);
+}
+
+QXPMemoryStats::Usage QXPMemoryStats::usage(const Category category) const
+{
+  std::lock_guard<std::mutex> lock(m_impl->mutex);
+  if (category >= CATEGORY_COUNT)
+    return m_impl->total;
+  return m_impl->usage[category];
+}
+
+QXPMemoryStats::Usage QXPMemoryStats::total() const
+{
+  std::lock_guard<std::mutex> lock(m_impl->mutex);
+  return m_impl->total;
+}
+
+const char *QXPMemoryStats::categoryName(const Category category)
+{
+  switch (category)
+  {
+  case CATEGORY_PICTURES:
+    return "pictures";
+  case CATEGORY_TEXTS:
+    return "texts";
+  case CATEGORY_PAGES:
+    return "pages";
+  case CATEGORY_STREAMS:
+    return "streams";
+  case CATEGORY_OUTPUT:
+    return "output";
+  default:
+    break;
+  }
+  return "total";
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
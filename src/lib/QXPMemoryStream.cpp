@@ -9,27 +9,59 @@
 
 #include "QXPMemoryStream.h"
 
-#include <algorithm>
+#include <utility>
+
+#include <libqxp/QXPMemoryStats.h>
 
 namespace libqxp
 {
 
-QXPMemoryStream::QXPMemoryStream(const unsigned char *data, unsigned length)
-  : m_data()
-  , m_length((long) length)
-  , m_pos(0)
+struct QXPMemoryStream::Data
 {
-  if (length > 0)
+  Data(std::vector<unsigned char> &&bytes_, QXPMemoryStats *const memoryStats_)
+    : bytes(std::move(bytes_))
+    , memoryStats(memoryStats_)
+  {
+    if (memoryStats)
+      memoryStats->allocate(QXPMemoryStats::CATEGORY_STREAMS, bytes.size());
+  }
+
+  ~Data()
   {
-    m_data.reset(new unsigned char[length]);
-    std::copy(data, data + length, m_data.get());
+    if (memoryStats)
+      memoryStats->release(QXPMemoryStats::CATEGORY_STREAMS, bytes.size());
   }
+
+  const std::vector<unsigned char> bytes;
+  QXPMemoryStats *const memoryStats;
+};
+
+QXPMemoryStream::QXPMemoryStream(const unsigned char *data, unsigned length, QXPMemoryStats *const memoryStats)
+  : QXPMemoryStream(std::vector<unsigned char>(data, data + length), memoryStats)
+{
+}
+
+QXPMemoryStream::QXPMemoryStream(std::vector<unsigned char> &&data, QXPMemoryStats *const memoryStats)
+  : QXPMemoryStream(std::make_shared<const Data>(std::move(data), memoryStats))
+{
+}
+
+QXPMemoryStream::QXPMemoryStream(const std::shared_ptr<const Data> &data)
+  : m_data(data)
+  , m_length(long(data->bytes.size()))
+  , m_pos(0)
+{
 }
 
 QXPMemoryStream::~QXPMemoryStream()
 {
 }
 
+std::shared_ptr<QXPMemoryStream> QXPMemoryStream::view() const
+{
+  return std::shared_ptr<QXPMemoryStream>(new QXPMemoryStream(m_data));
+}
+
 bool QXPMemoryStream::isStructured()
 {
   return false;
@@ -74,7 +106,7 @@ const unsigned char *QXPMemoryStream::read(unsigned long numBytes, unsigned long
   m_pos += numBytes;
 
   numBytesRead = numBytes;
-  return m_data.get() + oldPos;
+  return m_data->bytes.data() + oldPos;
 }
 catch (...)
 {
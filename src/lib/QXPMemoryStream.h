@@ -11,12 +11,15 @@
 #define QXPMEMORYSTREAM_H_INCLUDED
 
 #include <memory>
+#include <vector>
 
 #include <librevenge-stream/librevenge-stream.h>
 
 namespace libqxp
 {
 
+class QXPMemoryStats;
+
 class QXPMemoryStream : public librevenge::RVNGInputStream
 {
 // disable copying
@@ -24,9 +27,15 @@ class QXPMemoryStream : public librevenge::RVNGInputStream
   QXPMemoryStream &operator=(const QXPMemoryStream &other) = delete;
 
 public:
-  QXPMemoryStream(const unsigned char *data, unsigned length);
+  QXPMemoryStream(const unsigned char *data, unsigned length, QXPMemoryStats *memoryStats = nullptr);
+  // takes the data over, without copying them
+  explicit QXPMemoryStream(std::vector<unsigned char> &&data, QXPMemoryStats *memoryStats = nullptr);
   ~QXPMemoryStream() override;
 
+  // returns another stream reading the same data from the start; the data are shared, not copied,
+  // so the streams can be read on different threads
+  std::shared_ptr<QXPMemoryStream> view() const;
+
   bool isStructured() override;
   unsigned subStreamCount() override;
   const char *subStreamName(unsigned id) override;
@@ -40,7 +49,11 @@ public:
   bool isEnd() override;
 
 private:
-  std::unique_ptr<unsigned char[]> m_data;
+  struct Data;
+
+  explicit QXPMemoryStream(const std::shared_ptr<const Data> &data);
+
+  std::shared_ptr<const Data> m_data;
   const long m_length;
   long m_pos;
 };
@@ -0,0 +1,64 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <libqxp/QXPParseOptions.h>
+
+namespace libqxp
+{
+
+QXPParseOptions::QXPParseOptions()
+  : m_cancelled(false)
+  , m_hasDeadline(false)
+  , m_deadline()
+  , m_maxThreads(1)
+{
+}
+
+QXPParseOptions::~QXPParseOptions()
+{
+}
+
+void QXPParseOptions::setDeadline(const Clock::time_point deadline)
+{
+  m_deadline = deadline;
+  m_hasDeadline = true;
+}
+
+bool QXPParseOptions::isPastDeadline() const
+{
+  return m_hasDeadline && Clock::now() >= m_deadline;
+}
+
+void QXPParseOptions::cancel()
+{
+  m_cancelled = true;
+}
+
+bool QXPParseOptions::isCancelled() const
+{
+  return m_cancelled;
+}
+
+void QXPParseOptions::setMaxThreads(const unsigned maxThreads)
+{
+  m_maxThreads = maxThreads;
+}
+
+unsigned QXPParseOptions::maxThreads() const
+{
+  return m_maxThreads;
+}
+
+void QXPParseOptions::progress(unsigned, unsigned)
+{
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
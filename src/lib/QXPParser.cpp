@@ -9,17 +9,65 @@
 
 #include "QXPParser.h"
 
+#include <libqxp/QXPFileStream.h>
+#include <libqxp/QXPParseOptions.h>
+
+#include "QXPChainStream.h"
+#include "QXPCollectorRecorder.h"
 #include "QXPContentCollector.h"
 #include "QXPHeader.h"
+#include "QXPMemoryStream.h"
+#include "QXPReadaheadPlanner.h"
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <thread>
 
 namespace libqxp
 {
 
 using std::make_shared;
 
+namespace
+{
+
+// pages parsed per thread at least, if the count of threads is not given
+const unsigned MIN_PAGES_PER_THREAD = 8;
+
+// how many pages may be parsed ahead of the one being collected, per thread
+const size_t PAGES_AHEAD_PER_THREAD = 4;
+
+// stories and pictures read the input one at a time, so more threads would just wait
+const unsigned MAX_BACKGROUND_THREADS = 4;
+
+// announcing a small gap is cheaper than another seek when the chains are read
+const unsigned long READAHEAD_MAX_GAP = 4096;
+
+// stories and pictures parsed in place before the background pool is started; starting its threads
+// costs more than a few small stories, and most documents parsed in order have only a few
+const unsigned MIN_BACKGROUND_CONTENT = 16;
+
+struct PendingPage
+{
+  explicit PendingPage(const QXPCollector &target)
+    : recorder(target)
+    , done(false)
+    , parsed(false)
+    , error()
+  {
+  }
+
+  QXPCollectorRecorder recorder;
+  bool done;
+  bool parsed;
+  std::exception_ptr error;
+};
+
+}
+
 QXPParser::QXPParser(const std::shared_ptr<librevenge::RVNGInputStream> &input, librevenge::RVNGDrawingInterface *painter, const std::shared_ptr<QXPHeader> &header)
   : m_input(input)
   , m_painter(painter)
@@ -28,13 +76,25 @@ QXPParser::QXPParser(const std::shared_ptr<librevenge::RVNGInputStream> &input,
   , m_textParser(input, header)
   , m_colors()
   , m_fonts()
-  , m_charFormats()
-  , m_paragraphFormats()
-  , m_lineStyles()
+  , m_textFormats(make_shared<TextFormats>())
+  , m_lineStyles(make_shared<std::map<unsigned, LineStyle>>())
   , m_arrows()
   , m_hjs()
   , m_groupObjects()
   , m_header(header)
+  , m_memoryStats(nullptr)
+  , m_maxThreads(1)
+  , m_minBackgroundContent(MIN_BACKGROUND_CONTENT)
+  , m_contentCount(0)
+  , m_parseOptions(nullptr)
+  , m_reportProgress(false)
+  , m_pagesDone(0)
+  , m_streamPages(false)
+  , m_inputMutex(make_shared<std::mutex>())
+  , m_pagesStream()
+  , m_nextCheckpoint()
+  , m_nextPage(0)
+  , m_backgroundPool()
 {
   // default colors, in case parsing fails
   m_colors[0] = Color(255, 255, 255); // white
@@ -48,37 +108,380 @@ QXPParser::QXPParser(const std::shared_ptr<librevenge::RVNGInputStream> &input,
   m_colors[8] = Color(0, 0, 0); // registration
 
   // customm dashes are available only from 4.0
-  m_lineStyles[0] = LineStyle({}, true, 1.0, LineCapType::BUTT, LineJoinType::MITER);
-  m_lineStyles[1] = LineStyle({0.6, 0.4}, true, 5.0, LineCapType::BUTT, LineJoinType::MITER);
-  m_lineStyles[2] = LineStyle({0.75, 0.25}, true, 4.0, LineCapType::BUTT, LineJoinType::MITER);
-  m_lineStyles[3] = LineStyle({0.5455, 0.1818, 0.0909, 0.1818}, true, 11.0, LineCapType::BUTT, LineJoinType::MITER);
-  m_lineStyles[4] = LineStyle({0.0, 1.0}, true, 2.0, LineCapType::ROUND, LineJoinType::MITER);
-
-  m_arrows = std::vector<Arrow>( // should be in ctor, but breaks astyle
+  auto &lineStyles = *m_lineStyles;
+  lineStyles[0] = LineStyle({}, true, 1.0, LineCapType::BUTT, LineJoinType::MITER);
+  lineStyles[1] = LineStyle({0.6, 0.4}, true, 5.0, LineCapType::BUTT, LineJoinType::MITER);
+  lineStyles[2] = LineStyle({0.75, 0.25}, true, 4.0, LineCapType::BUTT, LineJoinType::MITER);
+  lineStyles[3] = LineStyle({0.5455, 0.1818, 0.0909, 0.1818}, true, 11.0, LineCapType::BUTT, LineJoinType::MITER);
+  lineStyles[4] = LineStyle({0.0, 1.0}, true, 2.0, LineCapType::ROUND, LineJoinType::MITER);
+
+  m_arrows = make_shared<const std::vector<Arrow>>(std::vector<Arrow>( // should be in ctor, but breaks astyle
   {
     // does viewbox has any effect?
     Arrow("m9 0 l-9 25 l6 -1.5 l6 0 l6 1.5 z", "0 0 18 25", 3),
     Arrow("m9 5 l-9 -5 l0 20 l6 10 l6 0 l6 -10 l0 -20 z", "0 0 18 35", 2.5)
-  });
+  }));
 }
 
 bool QXPParser::parse()
 {
-  QXPContentCollector collector(m_painter);
-
-  collector.startDocument();
+  QXPContentCollector collector(m_painter, m_memoryStats);
+  return parse(collector);
+}
 
-  auto docStream = m_blockParser.getChain(3);
-  if (!parseDocument(docStream, collector))
+bool QXPParser::parse(QXPCollector &collector) try
+{
+  if (!startPages(collector))
     return false;
 
+  // the whole document chain is not needed after the pages
+  const auto docStream = std::move(m_pagesStream);
   if (!parsePages(docStream, collector))
     return false;
 
+  checkLimits();
   collector.endDocument();
 
   return true;
 }
+catch (const ParseInterrupted &)
+{
+  collector.abortDocument();
+  throw;
+}
+
+bool QXPParser::startPages(QXPCollector &collector)
+{
+  collector.startDocument();
+
+  if (m_streamPages)
+    m_pagesStream = make_shared<QXPChainStream>(m_blockParser, 3, m_inputMutex, m_memoryStats);
+  else
+    m_pagesStream = m_blockParser.getChain(3);
+  if (!parseDocument(m_pagesStream, collector))
+    return false;
+
+  collector.collectColors(m_colors);
+  collector.collectTextFormats(*m_textFormats);
+
+  m_nextCheckpoint = firstPageCheckpoint(m_pagesStream);
+  m_nextPage = 0;
+
+  return true;
+}
+
+bool QXPParser::parseNextPage(QXPCollector &collector)
+{
+  while (hasNextPage())
+  {
+    const unsigned ind = m_nextPage++;
+    const bool isMaster = ind < m_header->masterPagesCount();
+
+    // don't output master pages, everything is included in normal pages
+    if (isMaster || !collector.isPageNeeded(ind - m_header->masterPagesCount()))
+    {
+      skipPageAt(m_pagesStream, m_nextCheckpoint, isMaster ? nullptr : &collector, nullptr);
+      if (!isMaster)
+        pageDone();
+      continue;
+    }
+
+    const bool parsed = parsePageAt(m_pagesStream, m_nextCheckpoint, collector);
+    pageDone();
+    return parsed;
+  }
+  return false;
+}
+
+bool QXPParser::hasNextPage() const
+{
+  return bool(m_pagesStream) && m_nextPage < m_header->pagesCount() + m_header->masterPagesCount();
+}
+
+std::unique_ptr<QXPParser> QXPParser::createPageParser() const
+{
+  return std::unique_ptr<QXPParser>();
+}
+
+unsigned QXPParser::pageThreads(const unsigned pageCount) const
+{
+  if (m_maxThreads == 1 || pageCount == 0)
+    return 1;
+  // an explicit count is used as is; the workers are limited to the number of pages anyway
+  if (m_maxThreads > 1)
+    return m_maxThreads;
+  // not worth it for small documents
+  const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+  return std::max(1u, std::min(cpus, pageCount / MIN_PAGES_PER_THREAD));
+}
+
+bool QXPParser::parsePagesConcurrently(const std::shared_ptr<librevenge::RVNGInputStream> &stream, const std::vector<PageCheckpoint> &checkpoints, const unsigned threadCount, QXPCollector &collector)
+{
+  if (checkpoints.empty())
+    return true;
+
+  const size_t workerCount = std::min<size_t>(std::max(threadCount, 1u), checkpoints.size());
+  const size_t maxAhead = PAGES_AHEAD_PER_THREAD * workerCount;
+
+  // the workers share the pages, each reads them through its own view
+  auto shared = std::dynamic_pointer_cast<QXPMemoryStream>(stream);
+  if (!shared)
+  {
+    seek(stream, 0);
+    const unsigned long length = getRemainingLength(stream);
+    shared = make_shared<QXPMemoryStream>(readNBytes(stream, length), unsigned(length), m_memoryStats);
+  }
+
+  std::vector<std::unique_ptr<QXPParser>> parsers;
+  std::vector<std::shared_ptr<librevenge::RVNGInputStream>> streams;
+  for (size_t i = 0; i != workerCount; ++i)
+  {
+    auto parser = createPageParser();
+    if (!parser)
+      throw GenericException();
+    parser->shareDocument(*this);
+    parsers.push_back(std::move(parser));
+    streams.push_back(shared->view());
+  }
+
+  std::deque<PendingPage> pages;
+  for (size_t i = 0; i != checkpoints.size(); ++i)
+    pages.emplace_back(collector);
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  size_t next = 0;
+  size_t collected = 0;
+
+  auto work = [&](QXPParser &parser, const std::shared_ptr<librevenge::RVNGInputStream> &pageStream)
+  {
+    while (true)
+    {
+      size_t index = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        // do not run too far ahead, recorded pages are held in memory
+        changed.wait(lock, [&]
+        {
+          return next >= pages.size() || next < collected + maxAhead;
+        });
+        if (next >= pages.size())
+          return;
+        index = next++;
+      }
+
+      PendingPage &page = pages[index];
+      bool parsed = false;
+      std::exception_ptr error;
+      try
+      {
+        PageCheckpoint checkpoint = checkpoints[index];
+        parsed = parser.parsePageAt(pageStream, checkpoint, page.recorder);
+      }
+      catch (...)
+      {
+        error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        page.parsed = parsed;
+        page.error = error;
+        page.done = true;
+      }
+      changed.notify_all();
+    }
+  };
+
+  auto stop = [&]()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      next = pages.size();
+    }
+    changed.notify_all();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workerCount);
+  bool result = true;
+  try
+  {
+    // started here, so the ones already running are stopped if starting another fails
+    for (size_t i = 0; i != workerCount; ++i)
+      threads.emplace_back(work, std::ref(*parsers[i]), streams[i]);
+
+    for (auto &page : pages)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&]
+        {
+          return page.done;
+        });
+      }
+
+      if (page.error)
+        std::rethrow_exception(page.error);
+      if (!page.parsed)
+      {
+        result = false;
+        break;
+      }
+
+      // the workers may be done already, so this is the last chance to stop
+      checkLimits();
+      page.recorder.replay(collector);
+      page.recorder.clear();
+      pageDone();
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++collected;
+      }
+      changed.notify_all();
+    }
+  }
+  catch (...)
+  {
+    stop();
+    for (auto &thread : threads)
+      thread.join();
+    throw;
+  }
+
+  stop();
+  for (auto &thread : threads)
+    thread.join();
+
+  return result;
+}
+
+void QXPParser::readAhead(const QXPReadaheadPlanner &planner) const
+{
+  // only a file can be told; other inputs are in memory already or have no way to pass it on
+  const auto file = dynamic_cast<const QXPFileStream *>(m_input.get());
+  if (!file || planner.empty())
+    return;
+
+  for (const auto &range : planner.plan(READAHEAD_MAX_GAP))
+    file->willNeed(range.first, range.second);
+}
+
+void QXPParser::setMemoryStats(QXPMemoryStats *const memoryStats)
+{
+  m_memoryStats = memoryStats;
+  m_blockParser.setMemoryStats(memoryStats);
+  m_textParser.setMemoryStats(memoryStats);
+}
+
+void QXPParser::setMaxThreads(const unsigned maxThreads)
+{
+  m_maxThreads = maxThreads;
+}
+
+void QXPParser::setStreamPages(const bool streamPages)
+{
+  m_streamPages = streamPages;
+}
+
+void QXPParser::setMinBackgroundContent(const unsigned count)
+{
+  m_minBackgroundContent = count;
+}
+
+void QXPParser::setParseOptions(QXPParseOptions *const parseOptions, const bool reportProgress)
+{
+  m_parseOptions = parseOptions;
+  m_reportProgress = reportProgress;
+  m_blockParser.setParseOptions(parseOptions);
+  m_textParser.setParseOptions(parseOptions);
+}
+
+void QXPParser::checkLimits() const
+{
+  checkParseLimits(m_parseOptions);
+}
+
+void QXPParser::pageDone()
+{
+  ++m_pagesDone;
+  if (m_parseOptions && m_reportProgress)
+    m_parseOptions->progress(m_pagesDone, m_header->pagesCount());
+}
+
+void QXPParser::shareDocument(const QXPParser &other)
+{
+  m_colors = other.m_colors;
+  m_fonts = other.m_fonts;
+  m_textFormats = other.m_textFormats;
+  m_lineStyles = other.m_lineStyles;
+  m_arrows = other.m_arrows;
+  m_hjs = other.m_hjs;
+  m_inputMutex = other.m_inputMutex;
+  setMemoryStats(other.m_memoryStats);
+  // workers do not report progress, the pages are done once they are collected
+  setParseOptions(other.m_parseOptions, false);
+}
+
+std::unique_lock<std::mutex> QXPParser::lockInput() const
+{
+  return std::unique_lock<std::mutex>(*m_inputMutex);
+}
+
+bool QXPParser::useBackground()
+{
+  if (m_maxThreads == 1)
+    return false;
+  return ++m_contentCount > m_minBackgroundContent;
+}
+
+QXPWorkerPool &QXPParser::backgroundPool()
+{
+  if (!m_backgroundPool)
+  {
+    const unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    m_backgroundPool.reset(new QXPWorkerPool(m_maxThreads > 1 ? m_maxThreads : std::min(cpus, MAX_BACKGROUND_THREADS)));
+  }
+  return *m_backgroundPool;
+}
+
+TextFuture QXPParser::decodeText(const unsigned index)
+{
+  const auto formats = m_textFormats;
+  return backgroundPool().submit([this, index, formats]()
+  {
+    auto text = make_shared<Text>();
+    try
+    {
+      std::shared_ptr<librevenge::RVNGInputStream> infoStream;
+      {
+        const auto inputLock = lockInput();
+        infoStream = m_textParser.readText(index, formats, *text);
+      }
+      // the formats are decoded from the copy of the chain, while others read the input
+      m_textParser.parseFormats(infoStream, *text);
+    }
+    catch (const ParseInterrupted &)
+    {
+      throw;
+    }
+    catch (...)
+    {
+      QXP_DEBUG_MSG(("Failed to parse text %u\n", index));
+      text = make_shared<Text>();
+    }
+    return text;
+  }).share();
+}
+
+PictureFuture QXPParser::loadPicture(const unsigned index)
+{
+  return backgroundPool().submit([this, index]()
+  {
+    return readPicture(index);
+  }).share();
+}
 
 Color QXPParser::getColor(unsigned id, Color defaultColor) const
 {
@@ -93,8 +496,8 @@ Color QXPParser::getColor(unsigned id, Color defaultColor) const
 
 const LineStyle *QXPParser::getLineStyle(unsigned id) const
 {
-  auto it = m_lineStyles.find(id);
-  if (it == m_lineStyles.end())
+  auto it = m_lineStyles->find(id);
+  if (it == m_lineStyles->end())
   {
     QXP_DEBUG_MSG(("Line style %u not found\n", id));
     return nullptr;
@@ -166,11 +569,14 @@ void QXPParser::parseHJs(const std::shared_ptr<librevenge::RVNGInputStream> &str
 
 void QXPParser::parseCharFormats(const std::shared_ptr<librevenge::RVNGInputStream> &stream)
 {
-  m_charFormats.clear();
+  // texts parsed so far keep referring to the old table
+  auto formats = make_shared<TextFormats>(*m_textFormats);
+  formats->charFormats.clear();
   parseCollection(stream, [=]()
   {
-    m_charFormats.push_back(make_shared<CharFormat>(parseCharFormat(stream)));
+    formats->charFormats.push_back(parseCharFormat(stream));
   });
+  m_textFormats = formats;
 }
 
 void QXPParser::parseHJProps(const std::shared_ptr<librevenge::RVNGInputStream> &stream, HJ &result)
@@ -229,11 +635,13 @@ TabStop QXPParser::parseTabStop(const std::shared_ptr<librevenge::RVNGInputStrea
 
 void QXPParser::parseParagraphFormats(const std::shared_ptr<librevenge::RVNGInputStream> &stream)
 {
-  m_paragraphFormats.clear();
+  auto formats = make_shared<TextFormats>(*m_textFormats);
+  formats->paragraphFormats.clear();
   parseCollection(stream, [=]()
   {
-    m_paragraphFormats.push_back(make_shared<ParagraphFormat>(parseParagraphFormat(stream)));
+    formats->paragraphFormats.push_back(parseParagraphFormat(stream));
   });
+  m_textFormats = formats;
 }
 
 void QXPParser::parseCollection(const std::shared_ptr<librevenge::RVNGInputStream> stream, std::function<void()> itemHandler)
@@ -300,9 +708,52 @@ void QXPParser::parsePicture(unsigned index, QXPCollector &collector)
 {
   if (!index)
     return;
+  switch (collector.pictureNeeds())
+  {
+  case ContentNeeds::NONE:
+    return;
+  case ContentNeeds::SIZE:
+    try
+    {
+      const auto inputLock = lockInput();
+      // the size is at the start of the first block
+      unsigned char size[4];
+      if (m_blockParser.readBlock(index, size, 4) == 4)
+      {
+        const uint32_t pictSize = be
+                                  ? (uint32_t(size[0]) << 24 | uint32_t(size[1]) << 16 | uint32_t(size[2]) << 8 | size[3])
+                                  : (uint32_t(size[3]) << 24 | uint32_t(size[2]) << 16 | uint32_t(size[1]) << 8 | size[0]);
+        collector.collectPictureSize(index, pictSize);
+      }
+    }
+    catch (...)
+    {
+      QXP_DEBUG_MSG(("Failed to read size of picture %u\n", index));
+    }
+    return;
+  case ContentNeeds::FULL:
+    break;
+  }
+  if (useBackground())
+  {
+    collector.collectPendingPicture(index, loadPicture(index));
+    return;
+  }
+  const librevenge::RVNGBinaryData data = readPicture(index);
+  if (!data.empty())
+    collector.collectPicture(index, data);
+}
+
+librevenge::RVNGBinaryData QXPParser::readPicture(const unsigned index)
+{
+  librevenge::RVNGBinaryData data;
   try
   {
-    auto pictureStream = m_blockParser.getChain(index);
+    std::shared_ptr<librevenge::RVNGInputStream> pictureStream;
+    {
+      const auto inputLock = lockInput();
+      pictureStream = m_blockParser.getChain(index);
+    }
     if (pictureStream)
     {
       uint32_t pictSize=readU32(pictureStream, be);
@@ -349,27 +800,62 @@ void QXPParser::parsePicture(unsigned index, QXPCollector &collector)
       if (!ok || (readData=pictureStream->read(static_cast<unsigned long>(pictSize), sizeRead)) == nullptr || long(sizeRead)!=pictSize)
       {
         QXP_DEBUG_MSG(("Failed to read picture %u\n", index));
-        return;
+        return data;
       }
-      librevenge::RVNGBinaryData data;
       data.append(readData, sizeRead);
-      collector.collectPicture(index, data);
     }
   }
+  catch (const ParseInterrupted &)
+  {
+    throw;
+  }
   catch (...)
   {
     QXP_DEBUG_MSG(("Failed to parse picture %u\n", index));
+    data.clear();
   }
+  return data;
 }
 
-std::shared_ptr<Text> QXPParser::parseText(unsigned index, unsigned linkId, QXPCollector &collector)
+boost::optional<std::shared_ptr<Text>> QXPParser::parseText(unsigned index, unsigned linkId, QXPCollector &collector)
 {
   try
   {
-    auto text = m_textParser.parseText(index, m_charFormats, m_paragraphFormats);
+    switch (collector.textNeeds())
+    {
+    case ContentNeeds::NONE:
+      return make_shared<Text>();
+    case ContentNeeds::SIZE:
+    {
+      const auto runs = make_shared<Text>();
+      unsigned long length = 0;
+      {
+        const auto inputLock = lockInput();
+        length = m_textParser.parseTextRuns(index, m_textFormats, *runs);
+      }
+      collector.collectTextLength(runs, linkId, length);
+      return make_shared<Text>();
+    }
+    case ContentNeeds::FULL:
+      break;
+    }
+    if (useBackground())
+    {
+      collector.collectPendingText(decodeText(index), linkId);
+      return boost::none;
+    }
+    std::shared_ptr<Text> text;
+    {
+      const auto inputLock = lockInput();
+      text = m_textParser.parseText(index, m_textFormats);
+    }
     collector.collectText(text, linkId);
     return text;
   }
+  catch (const ParseInterrupted &)
+  {
+    throw;
+  }
   catch (...)
   {
     QXP_DEBUG_MSG(("Failed to parse text %u\n", index));
@@ -566,22 +1052,22 @@ void QXPParser::setArrow(const unsigned index, Frame &frame) const
   switch (index)
   {
   case 1:
-    frame.endArrow = &m_arrows[0];
+    frame.endArrow = &(*m_arrows)[0];
     break;
   case 2:
-    frame.startArrow = &m_arrows[0];
+    frame.startArrow = &(*m_arrows)[0];
     break;
   case 3:
-    frame.startArrow = &m_arrows[1];
-    frame.endArrow = &m_arrows[0];
+    frame.startArrow = &(*m_arrows)[1];
+    frame.endArrow = &(*m_arrows)[0];
     break;
   case 4:
-    frame.startArrow = &m_arrows[0];
-    frame.endArrow = &m_arrows[1];
+    frame.startArrow = &(*m_arrows)[0];
+    frame.endArrow = &(*m_arrows)[1];
     break;
   case 5:
-    frame.startArrow = &m_arrows[0];
-    frame.endArrow = &m_arrows[0];
+    frame.startArrow = &(*m_arrows)[0];
+    frame.endArrow = &(*m_arrows)[0];
     break;
   }
 }
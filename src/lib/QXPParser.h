@@ -12,20 +12,26 @@
 
 #include "libqxp_utils.h"
 #include "QXPBlockParser.h"
+#include "QXPCollector.h"
 #include "QXPTextParser.h"
 #include "QXPTypes.h"
+#include "QXPWorkerPool.h"
 
 #include <deque>
 #include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <set>
 #include <vector>
 
 namespace libqxp
 {
 
-class QXPCollector;
 class QXPHeader;
+class QXPMemoryStats;
+class QXPParseOptions;
+class QXPReadaheadPlanner;
 
 class QXPParser
 {
@@ -38,8 +44,36 @@ public:
   virtual ~QXPParser() = default;
 
   bool parse();
+  bool parse(QXPCollector &collector);
+
+  // parses everything before the pages, so they can then be parsed one at a time
+  bool startPages(QXPCollector &collector);
+  // parses the next page the collector needs, skipping the others;
+  // returns false if there is no such page left
+  bool parseNextPage(QXPCollector &collector);
+  bool hasNextPage() const;
+
+  void setMemoryStats(QXPMemoryStats *memoryStats);
+  // limits are checked at page and object boundaries and while chains are read;
+  // progress is only reported if reportProgress is set
+  void setParseOptions(QXPParseOptions *parseOptions, bool reportProgress = true);
+  // pages are parsed on at most maxThreads threads; 0 picks the count by document size and CPUs.
+  // Unless it is 1, stories and pictures are loaded in the background while pages are parsed in order,
+  // once more than setMinBackgroundContent() of them have been parsed in place.
+  void setMaxThreads(unsigned maxThreads);
+  void setMinBackgroundContent(unsigned count);
+  // startPages reads the document chain as the pages are parsed instead of copying it at once
+  void setStreamPages(bool streamPages);
 
 protected:
+  // where a page starts and the deobfuscator state there; enough to parse the page alone
+  struct PageCheckpoint
+  {
+    unsigned long offset;
+    uint16_t seed;
+    uint16_t increment;
+  };
+
   const std::shared_ptr<librevenge::RVNGInputStream> m_input;
   librevenge::RVNGDrawingInterface *m_painter;
   const bool be; // big endian
@@ -49,10 +83,10 @@ protected:
 
   std::map<unsigned, Color> m_colors;
   std::map<int, std::string> m_fonts;
-  std::vector<std::shared_ptr<CharFormat>> m_charFormats;
-  std::vector<std::shared_ptr<ParagraphFormat>> m_paragraphFormats;
-  std::map<unsigned, LineStyle> m_lineStyles;
-  std::vector<Arrow> m_arrows;
+  std::shared_ptr<const TextFormats> m_textFormats;
+  // frames point into these, so they are shared with page workers instead of copied
+  std::shared_ptr<std::map<unsigned, LineStyle>> m_lineStyles;
+  std::shared_ptr<const std::vector<Arrow>> m_arrows;
   std::deque<std::shared_ptr<HJ>> m_hjs;
 
   std::set<unsigned> m_groupObjects;
@@ -66,6 +100,28 @@ protected:
 
   virtual bool parseDocument(const std::shared_ptr<librevenge::RVNGInputStream> &docStream, QXPCollector &collector) = 0;
   virtual bool parsePages(const std::shared_ptr<librevenge::RVNGInputStream> &stream, QXPCollector &collector) = 0;
+  // the checkpoint of the first page, which starts at the current position of stream
+  virtual PageCheckpoint firstPageCheckpoint(const std::shared_ptr<librevenge::RVNGInputStream> &stream) const = 0;
+  // parses a page and its objects from its checkpoint and moves the checkpoint to the next page
+  virtual bool parsePageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector &collector) = 0;
+  // moves the checkpoint to the next page, without building this one; story heads are passed
+  // to storyCollector and content chains to readahead, if they are given
+  virtual void skipPageAt(const std::shared_ptr<librevenge::RVNGInputStream> &stream, PageCheckpoint &checkpoint, QXPCollector *storyCollector, QXPReadaheadPlanner *readahead) = 0;
+  // creates an empty parser of the same format, to parse pages on another thread
+  virtual std::unique_ptr<QXPParser> createPageParser() const;
+
+  // throws if the parse has to stop
+  void checkLimits() const;
+  // reports progress after a page that is not a master page has been parsed or skipped
+  void pageDone();
+
+  // returns how many threads to parse pageCount pages with; 1 means in order, on this thread
+  unsigned pageThreads(unsigned pageCount) const;
+  // parses the pages on worker threads, passing them to collector in order of checkpoints;
+  // returns false if a page could not be parsed
+  bool parsePagesConcurrently(const std::shared_ptr<librevenge::RVNGInputStream> &stream, const std::vector<PageCheckpoint> &checkpoints, unsigned threads, QXPCollector &collector);
+  // tells the input which ranges are going to be read, if it is a file
+  void readAhead(const QXPReadaheadPlanner &planner) const;
 
   void skipRecord(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
   void parseFonts(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
@@ -85,7 +141,8 @@ protected:
   std::vector<PageSettings> parsePageSettings(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
 
   void parsePicture(unsigned index, QXPCollector &collector);
-  std::shared_ptr<Text> parseText(unsigned index, unsigned linkId, QXPCollector &collector);
+  // returns none if the text is decoded in the background, it is then only passed to collector
+  boost::optional<std::shared_ptr<Text>> parseText(unsigned index, unsigned linkId, QXPCollector &collector);
 
   uint32_t readRecordEndOffset(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
   uint8_t readColorComp(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
@@ -102,7 +159,35 @@ protected:
   void skipFileInfo(const std::shared_ptr<librevenge::RVNGInputStream> &stream);
 
 private:
+  // takes over everything parsed from the document so far
+  void shareDocument(const QXPParser &other);
+  // serializes reading of the input by page workers and story tasks
+  std::unique_lock<std::mutex> lockInput() const;
+  // reads and checks the picture; returns empty data if it is not valid
+  librevenge::RVNGBinaryData readPicture(unsigned index);
+  // counts the story or picture about to be parsed; returns true if it goes to the background pool
+  bool useBackground();
+  // created on first use
+  QXPWorkerPool &backgroundPool();
+  TextFuture decodeText(unsigned index);
+  PictureFuture loadPicture(unsigned index);
+
   const std::shared_ptr<QXPHeader> m_header;
+  QXPMemoryStats *m_memoryStats;
+  unsigned m_maxThreads;
+  unsigned m_minBackgroundContent;
+  unsigned m_contentCount;
+  QXPParseOptions *m_parseOptions;
+  bool m_reportProgress;
+  unsigned m_pagesDone;
+  bool m_streamPages;
+  std::shared_ptr<std::mutex> m_inputMutex;
+  // state of parsing pages one at a time
+  std::shared_ptr<librevenge::RVNGInputStream> m_pagesStream;
+  PageCheckpoint m_nextCheckpoint;
+  unsigned m_nextPage;
+  // last, so tasks are finished before the rest is destroyed
+  std::unique_ptr<QXPWorkerPool> m_backgroundPool;
 };
 
 }
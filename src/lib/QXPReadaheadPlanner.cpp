@@ -0,0 +1,64 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPReadaheadPlanner.h"
+
+namespace libqxp
+{
+
+QXPReadaheadPlanner::QXPReadaheadPlanner(const uint32_t blockLength, const uint32_t blockCount, const bool texts, const bool pictures)
+  : m_blockLength(blockLength)
+  , m_blockCount(blockCount)
+  , m_texts(texts)
+  , m_pictures(pictures)
+  , m_blocks()
+{
+}
+
+void QXPReadaheadPlanner::addText(const uint32_t index)
+{
+  if (m_texts)
+    addChain(index);
+}
+
+void QXPReadaheadPlanner::addPicture(const uint32_t index)
+{
+  if (m_pictures)
+    addChain(index);
+}
+
+bool QXPReadaheadPlanner::empty() const
+{
+  return m_blocks.empty();
+}
+
+std::vector<QXPReadaheadPlanner::Range> QXPReadaheadPlanner::plan(const unsigned long maxGap) const
+{
+  std::vector<Range> ranges;
+  for (const uint32_t block : m_blocks)
+  {
+    const unsigned long offset = (block - 1) * static_cast<unsigned long>(m_blockLength);
+    if (!ranges.empty() && offset - (ranges.back().first + ranges.back().second) <= maxGap)
+      ranges.back().second = offset + m_blockLength - ranges.back().first;
+    else
+      ranges.push_back(Range(offset, m_blockLength));
+  }
+  return ranges;
+}
+
+void QXPReadaheadPlanner::addChain(const uint32_t index)
+{
+  // the same check as in QXPBlockParser
+  if (index > 0 && index <= m_blockCount)
+    m_blocks.insert(index);
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
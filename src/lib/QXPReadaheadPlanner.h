@@ -0,0 +1,58 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPREADAHEADPLANNER_H_INCLUDED
+#define QXPREADAHEADPLANNER_H_INCLUDED
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "libqxp_utils.h"
+
+namespace libqxp
+{
+
+/** Collects chains that are going to be read soon and plans the ranges
+  * of the input to announce, in the order of the input.
+  *
+  * Only the first block of a chain is known before the chain is
+  * walked, but the following blocks are often close to it.
+  */
+class QXPReadaheadPlanner
+{
+public:
+  // byte offset and length
+  typedef std::pair<unsigned long, unsigned long> Range;
+
+  QXPReadaheadPlanner(uint32_t blockLength, uint32_t blockCount, bool texts, bool pictures);
+
+  // chains of content the collector does not need are ignored
+  void addText(uint32_t index);
+  void addPicture(uint32_t index);
+
+  bool empty() const;
+  // ranges sorted by offset; blocks closer than maxGap bytes are merged into one range
+  std::vector<Range> plan(unsigned long maxGap) const;
+
+private:
+  void addChain(uint32_t index);
+
+  const uint32_t m_blockLength;
+  const uint32_t m_blockCount;
+  const bool m_texts;
+  const bool m_pictures;
+  std::set<uint32_t> m_blocks;
+};
+
+}
+
+#endif // QXPREADAHEADPLANNER_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,117 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPSubStream.h"
+
+namespace libqxp
+{
+
+QXPSubStream::QXPSubStream(const std::shared_ptr<librevenge::RVNGInputStream> &parent, const unsigned long offset, const unsigned long length)
+  : m_parent(parent)
+  , m_offset(long(offset))
+  , m_length(long(length))
+  , m_pos(0)
+{
+}
+
+bool QXPSubStream::isStructured()
+{
+  return false;
+}
+
+unsigned QXPSubStream::subStreamCount()
+{
+  return 0;
+}
+
+const char *QXPSubStream::subStreamName(unsigned)
+{
+  return 0;
+}
+
+bool QXPSubStream::existsSubStream(const char *)
+{
+  return false;
+}
+
+librevenge::RVNGInputStream *QXPSubStream::getSubStreamByName(const char *)
+{
+  return 0;
+}
+
+librevenge::RVNGInputStream *QXPSubStream::getSubStreamById(unsigned)
+{
+  return 0;
+}
+
+const unsigned char *QXPSubStream::read(unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+
+  if ((0 == numBytes) || !m_parent || (m_pos >= m_length))
+    return 0;
+
+  if (numBytes > static_cast<unsigned long>(m_length - m_pos))
+    numBytes = static_cast<unsigned long>(m_length - m_pos);
+
+  if (m_parent->seek(m_offset + m_pos, librevenge::RVNG_SEEK_SET) != 0)
+    return 0;
+  const unsigned char *const data = m_parent->read(numBytes, numBytesRead);
+  if (!data)
+  {
+    numBytesRead = 0;
+    return 0;
+  }
+  m_pos += long(numBytesRead);
+  return data;
+}
+catch (...)
+{
+  numBytesRead = 0;
+  return 0;
+}
+
+int QXPSubStream::seek(const long offset, librevenge::RVNG_SEEK_TYPE seekType)
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + m_pos;
+    break;
+  case librevenge::RVNG_SEEK_END :
+    pos = offset + m_length;
+    break;
+  default :
+    return -1;
+  }
+
+  if ((pos < 0) || (pos > m_length))
+    return 1;
+
+  m_pos = pos;
+  return 0;
+}
+
+long QXPSubStream::tell()
+{
+  return m_pos;
+}
+
+bool QXPSubStream::isEnd()
+{
+  return m_length == m_pos;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,57 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPSUBSTREAM_H_INCLUDED
+#define QXPSUBSTREAM_H_INCLUDED
+
+#include <memory>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+namespace libqxp
+{
+
+/** A read-only view of a byte range of another stream.
+  *
+  * Nothing is copied: every read seeks the parent stream and reads from it,
+  * so the parent must not be used concurrently.
+  */
+class QXPSubStream : public librevenge::RVNGInputStream
+{
+// disable copying
+  QXPSubStream(const QXPSubStream &other) = delete;
+  QXPSubStream &operator=(const QXPSubStream &other) = delete;
+
+public:
+  QXPSubStream(const std::shared_ptr<librevenge::RVNGInputStream> &parent, unsigned long offset, unsigned long length);
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  const std::shared_ptr<librevenge::RVNGInputStream> m_parent;
+  const long m_offset;
+  const long m_length;
+  long m_pos;
+};
+
+}
+
+#endif // QXPSUBSTREAM_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,93 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPTextCollector.h"
+
+#include <algorithm>
+
+#include <libqxp/QXPTextSink.h>
+
+#include "QXPTypes.h"
+
+namespace libqxp
+{
+
+QXPTextCollector::QXPTextCollector(QXPTextSink *const sink)
+  : m_sink(sink)
+  , m_story()
+{
+}
+
+ContentNeeds QXPTextCollector::pictureNeeds() const
+{
+  return ContentNeeds::NONE;
+}
+
+void QXPTextCollector::collectText(const std::shared_ptr<Text> &text, const unsigned /* linkId */)
+{
+  if (!text || !m_sink)
+    return;
+
+  m_story.clear();
+
+  // merge adjacent runs, skipping those that do not contain real text
+  unsigned long begin = 0;
+  unsigned long end = 0;
+  const auto &charFormats = text->charFormats;
+  for (size_t i = 0; i < charFormats.size(); ++i)
+  {
+    const unsigned long runEnd = std::min<unsigned long>(charFormats.afterEndIndex(i), text->text.size());
+    if (text->charFormat(i).isControlChars)
+    {
+      appendRun(*text, begin, end);
+      begin = runEnd;
+    }
+    end = runEnd;
+  }
+  if (charFormats.empty())
+    end = text->text.size();
+  appendRun(*text, begin, end);
+
+  m_sink->insertStory(m_story.data(), m_story.size());
+}
+
+void QXPTextCollector::appendRun(const Text &text, const unsigned long begin, const unsigned long end)
+{
+  if (begin >= end)
+    return;
+
+  librevenge::RVNGString str;
+  appendCharacters(str, text.text.data() + begin, end - begin, text.encoding);
+
+  const char *const chars = str.cstr();
+  const unsigned long length = str.size();
+  m_story.reserve(m_story.size() + length);
+  for (unsigned long i = 0; i < length; ++i)
+  {
+    const char c = chars[i];
+    switch (c)
+    {
+    case '\r':
+      m_story.push_back('\n');
+      break;
+    case '\n':
+    case '\t':
+      m_story.push_back(c);
+      break;
+    default:
+      if (static_cast<unsigned char>(c) >= 0x20)
+        m_story.push_back(c);
+      break;
+    }
+  }
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,47 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPTEXTCOLLECTOR_H_INCLUDED
+#define QXPTEXTCOLLECTOR_H_INCLUDED
+
+#include "QXPCollector.h"
+
+#include <string>
+
+namespace libqxp
+{
+
+class QXPTextSink;
+
+// Passes text of stories to a sink, ignoring everything else.
+class QXPTextCollector : public QXPCollector
+{
+  // disable copying
+  QXPTextCollector(const QXPTextCollector &other) = delete;
+  QXPTextCollector &operator=(const QXPTextCollector &other) = delete;
+
+public:
+  explicit QXPTextCollector(QXPTextSink *sink);
+
+  ContentNeeds pictureNeeds() const override;
+
+  void collectText(const std::shared_ptr<Text> &text, const unsigned linkId) override;
+
+private:
+  void appendRun(const Text &text, unsigned long begin, unsigned long end);
+
+  QXPTextSink *const m_sink;
+  std::string m_story;
+};
+
+}
+
+#endif // QXPTEXTCOLLECTOR_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -9,6 +9,9 @@
 
 #include "QXPTextParser.h"
 
+#include <algorithm>
+#include <utility>
+
 #include "QXPHeader.h"
 #include "QXPTypes.h"
 
@@ -20,34 +23,28 @@ using std::make_shared;
 namespace
 {
 
-template <class Format, class FormatSpec>
 void parseFormatSpec(
   const std::shared_ptr<librevenge::RVNGInputStream> &infoStream,
-  const std::vector<std::shared_ptr<Format>> &formats,
+  const size_t formatsCount,
   unsigned version, bool be,
-  std::vector<FormatSpec> &textFormats)
+  TextRuns &runs)
 {
   unsigned specLength = readU32(infoStream, be);
   if (specLength > getRemainingLength(infoStream))
     specLength = unsigned(getRemainingLength(infoStream));
+  runs.reserve(specLength / (version >= QXP_4 ? 8 : 6));
   const long end = infoStream->tell() + specLength;
   while (infoStream->tell() < end)
   {
-    const unsigned formatIndex = version >= QXP_4 ? readU32(infoStream, be) : readU16(infoStream, be);
+    unsigned formatIndex = version >= QXP_4 ? readU32(infoStream, be) : readU16(infoStream, be);
     const unsigned length = readU32(infoStream, be);
-    const unsigned startIndex = textFormats.empty() ? 0 : textFormats.back().afterEndIndex();
 
-    std::shared_ptr<Format> format;
-    if (formatIndex >= formats.size())
-    {
-      QXP_DEBUG_MSG(("Char format %u not found\n", formatIndex));
-      format = formats.empty() ? std::make_shared<Format>() : formats[0];
-    }
-    else
+    if (formatIndex >= formatsCount)
     {
-      format = formats[formatIndex];
+      QXP_DEBUG_MSG(("Format %u not found\n", formatIndex));
+      formatIndex = 0;
     }
-    textFormats.push_back(FormatSpec(format, startIndex, length));
+    runs.append(formatIndex, length);
   }
 }
 
@@ -61,35 +58,87 @@ QXPTextParser::QXPTextParser(const std::shared_ptr<librevenge::RVNGInputStream>
 {
 }
 
-std::shared_ptr<Text> QXPTextParser::parseText(unsigned index,
-                                               const std::vector<std::shared_ptr<CharFormat>> &charFormats,
-                                               const std::vector<std::shared_ptr<ParagraphFormat>> &paragraphFormats)
+std::shared_ptr<Text> QXPTextParser::parseText(unsigned index, const std::shared_ptr<const TextFormats> &formats)
+{
+  auto text = make_shared<Text>();
+  const auto infoStream = readText(index, formats, *text);
+  parseFormats(infoStream, *text);
+  return text;
+}
+
+std::shared_ptr<librevenge::RVNGInputStream> QXPTextParser::readText(unsigned index, const std::shared_ptr<const TextFormats> &formats, Text &text)
 {
   auto infoStream = m_blockParser.getChain(index);
 
-  auto text = make_shared<Text>();
-  text->encoding = m_encoding;
+  text.encoding = m_encoding;
+  text.formats = formats;
 
   skip(infoStream, 4);
 
+  // collect the blocks first, so the text can be read in one go
+  std::vector<std::pair<unsigned, unsigned>> blocks;
+  const unsigned long textLength = parseBlocksSpec(infoStream, blocks);
+
+  text.text.resize(textLength);
+  unsigned long pos = 0;
+  for (const auto &block : blocks)
+    pos += m_blockParser.readBlock(block.first, reinterpret_cast<unsigned char *>(&text.text[pos]), block.second);
+  text.text.resize(pos);
+
+  return infoStream;
+}
+
+void QXPTextParser::parseFormats(const std::shared_ptr<librevenge::RVNGInputStream> &infoStream, Text &text) const
+{
+  const TextFormats noFormats;
+  const TextFormats &textFormats = text.formats ? *text.formats : noFormats;
+  parseFormatSpec(infoStream, textFormats.charFormats.size(), m_header->version(), be, text.charFormats);
+  parseFormatSpec(infoStream, textFormats.paragraphFormats.size(), m_header->version(), be, text.paragraphs);
+
+  text.updateMetrics();
+}
+
+unsigned long QXPTextParser::parseTextRuns(const unsigned index, const std::shared_ptr<const TextFormats> &formats, Text &text)
+{
+  auto infoStream = m_blockParser.getChain(index);
+
+  text.encoding = m_encoding;
+  text.formats = formats;
+
+  skip(infoStream, 4);
+  std::vector<std::pair<unsigned, unsigned>> blocks;
+  const unsigned long textLength = parseBlocksSpec(infoStream, blocks);
+  // metrics are not updated, as there are no characters to measure
+  const size_t charFormatsCount = formats ? formats->charFormats.size() : 0;
+  const size_t paragraphFormatsCount = formats ? formats->paragraphFormats.size() : 0;
+  parseFormatSpec(infoStream, charFormatsCount, m_header->version(), be, text.charFormats);
+  parseFormatSpec(infoStream, paragraphFormatsCount, m_header->version(), be, text.paragraphs);
+  return textLength;
+}
+
+unsigned long QXPTextParser::parseBlocksSpec(const std::shared_ptr<librevenge::RVNGInputStream> &infoStream, std::vector<std::pair<unsigned, unsigned>> &blocks)
+{
+  unsigned long textLength = 0;
+  const unsigned blocksSpecLength = readU32(infoStream, be);
+  const long end = infoStream->tell() + blocksSpecLength;
+  while (infoStream->tell() < end)
   {
-    const unsigned blocksSpecLength = readU32(infoStream, be);
-    const long end = infoStream->tell() + blocksSpecLength;
-    while (infoStream->tell() < end)
-    {
-      const unsigned blockIndex = m_header->hasBigIndex() ? readU32(infoStream, be) : readU16(infoStream, be);
-      unsigned length = m_header->version() >= QXP_4 ? readU32(infoStream, be) : readU16(infoStream, be);
-      auto blockStream = m_blockParser.getBlock(blockIndex);
-      if (length > getRemainingLength(blockStream))
-        length = getRemainingLength(blockStream);
-      text->text += readString(blockStream, length);
-    }
+    const unsigned blockIndex = m_header->hasBigIndex() ? readU32(infoStream, be) : readU16(infoStream, be);
+    const unsigned length = m_header->version() >= QXP_4 ? readU32(infoStream, be) : readU16(infoStream, be);
+    blocks.push_back(std::make_pair(blockIndex, std::min<unsigned>(length, m_blockParser.blockLength())));
+    textLength += blocks.back().second;
   }
+  return textLength;
+}
 
-  parseFormatSpec(infoStream, charFormats, m_header->version(), be, text->charFormats);
-  parseFormatSpec(infoStream, paragraphFormats, m_header->version(), be, text->paragraphs);
+void QXPTextParser::setMemoryStats(QXPMemoryStats *const memoryStats)
+{
+  m_blockParser.setMemoryStats(memoryStats);
+}
 
-  return text;
+void QXPTextParser::setParseOptions(const QXPParseOptions *const parseOptions)
+{
+  m_blockParser.setParseOptions(parseOptions);
 }
 
 }
@@ -11,6 +11,7 @@
 #define QXPTEXTPARSER_H_INCLUDED
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "libqxp_utils.h"
@@ -20,10 +21,11 @@ namespace libqxp
 {
 
 class QXPHeader;
+class QXPMemoryStats;
+class QXPParseOptions;
 
-struct CharFormat;
-struct ParagraphFormat;
 struct Text;
+struct TextFormats;
 
 class QXPTextParser
 {
@@ -34,11 +36,21 @@ class QXPTextParser
 public:
   QXPTextParser(const std::shared_ptr<librevenge::RVNGInputStream> &input, const std::shared_ptr<QXPHeader> &header);
 
-  std::shared_ptr<Text> parseText(unsigned index,
-                                  const std::vector<std::shared_ptr<CharFormat>> &charFormats,
-                                  const std::vector<std::shared_ptr<ParagraphFormat>> &paragraphFormats);
+  std::shared_ptr<Text> parseText(unsigned index, const std::shared_ptr<const TextFormats> &formats);
+
+  // parseText in two steps: only the first one reads the input
+  std::shared_ptr<librevenge::RVNGInputStream> readText(unsigned index, const std::shared_ptr<const TextFormats> &formats, Text &text);
+  void parseFormats(const std::shared_ptr<librevenge::RVNGInputStream> &infoStream, Text &text) const;
+
+  // parses the formats of the text without reading the text itself; returns its length
+  unsigned long parseTextRuns(unsigned index, const std::shared_ptr<const TextFormats> &formats, Text &text);
+
+  void setMemoryStats(QXPMemoryStats *memoryStats);
+  void setParseOptions(const QXPParseOptions *parseOptions);
 
 private:
+  unsigned long parseBlocksSpec(const std::shared_ptr<librevenge::RVNGInputStream> &infoStream, std::vector<std::pair<unsigned, unsigned>> &blocks);
+
   const std::shared_ptr<QXPHeader> m_header;
   const bool be; // big endian
   const char *m_encoding;
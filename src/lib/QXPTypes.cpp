@@ -115,40 +115,101 @@ Color Color::applyShade(double shade) const
                uint8_t(std::round(blue + (255 - blue) * tint)));
 }
 
-bool TextSpec::overlaps(const TextSpec &other) const
+const CharFormat &TextFormats::charFormat(const unsigned index) const
 {
-  return startIndex <= other.endIndex() && other.startIndex <= endIndex();
+  static const CharFormat defaultFormat;
+  if (index < charFormats.size())
+    return charFormats[index];
+  return charFormats.empty() ? defaultFormat : charFormats[0];
 }
 
-double Text::maxFontSize() const
+const ParagraphFormat &TextFormats::paragraphFormat(const unsigned index) const
+{
+  static const ParagraphFormat defaultFormat;
+  if (index < paragraphFormats.size())
+    return paragraphFormats[index];
+  return paragraphFormats.empty() ? defaultFormat : paragraphFormats[0];
+}
+
+void TextRuns::append(const uint32_t formatIndex, const uint32_t length)
+{
+  const uint32_t start = afterEndIndex();
+  formatIndexes.push_back(formatIndex);
+  startIndexes.push_back(start);
+  lengths.push_back(length);
+}
+
+void TextRuns::reserve(const size_t count)
+{
+  formatIndexes.reserve(count);
+  startIndexes.reserve(count);
+  lengths.reserve(count);
+}
+
+const CharFormat &Text::charFormat(const size_t run) const
+{
+  static const TextFormats noFormats;
+  return (formats ? *formats : noFormats).charFormat(charFormats.formatIndexes[run]);
+}
+
+const ParagraphFormat &Text::paragraphFormat(const size_t run) const
+{
+  static const TextFormats noFormats;
+  return (formats ? *formats : noFormats).paragraphFormat(paragraphs.formatIndexes[run]);
+}
+
+void Text::updateMetrics()
 {
   if (charFormats.empty())
   {
-    QXP_DEBUG_MSG(("Text::maxFontSize no char formats\n"));
+    QXP_DEBUG_MSG(("Text::updateMetrics no char formats\n"));
   }
 
-  double maxSize = 0;
-  for (auto &charFormat : charFormats)
+  m_maxFontSize = 0;
+  for (size_t i = 0; i < charFormats.size(); ++i)
   {
-    if (!charFormat.format->isControlChars && charFormat.format->fontSize > maxSize)
+    const auto &format = charFormat(i);
+    if (!format.isControlChars && format.fontSize > m_maxFontSize)
     {
-      maxSize = charFormat.format->fontSize;
+      m_maxFontSize = format.fontSize;
     }
   }
-  return maxSize;
-}
 
-double Text::maxFontSize(const ParagraphSpec &paragraph) const
-{
-  double maxSize = 0;
-  for (auto &charFormat : charFormats)
+  // both paragraphs and char formats are sorted and do not overlap each other,
+  // so all paragraphs can be done in a single pass
+  paragraphMetrics.clear();
+  paragraphMetrics.resize(paragraphs.size());
+  size_t first = 0;
+  for (size_t i = 0; i < paragraphs.size(); ++i)
   {
-    if (!charFormat.format->isControlChars && charFormat.overlaps(paragraph) && charFormat.format->fontSize > maxSize)
+    auto &metrics = paragraphMetrics[i];
+
+    while (first < charFormats.size() && charFormats.afterEndIndex(first) <= paragraphs.startIndex(i))
+      ++first;
+    metrics.firstCharFormat = unsigned(first);
+
+    for (size_t j = first; j < charFormats.size() && charFormats.startIndex(j) < paragraphs.afterEndIndex(i); ++j)
     {
-      maxSize = charFormat.format->fontSize;
+      const auto &format = charFormat(j);
+      ++metrics.charFormatsCount;
+      if (!format.isControlChars && format.fontSize > metrics.maxFontSize)
+      {
+        metrics.maxFontSize = format.fontSize;
+      }
     }
   }
-  return maxSize;
+}
+
+double Text::maxFontSize() const
+{
+  return m_maxFontSize;
+}
+
+double Text::maxFontSize(const unsigned paragraph) const
+{
+  if (paragraph >= paragraphMetrics.size())
+    return 0;
+  return paragraphMetrics[paragraph].maxFontSize;
 }
 
 bool TextObject::isLinked() const
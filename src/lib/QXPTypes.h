@@ -272,44 +272,80 @@ enum class ContentType
   PICTURE
 };
 
-struct TextSpec
+// formats are shared by all texts of a document and referred to by index
+struct TextFormats
 {
-  const unsigned startIndex;
-  const unsigned length;
+  std::vector<CharFormat> charFormats;
+  std::vector<ParagraphFormat> paragraphFormats;
 
-  unsigned endIndex() const
+  TextFormats()
+    : charFormats(), paragraphFormats()
+  { }
+
+  // falls back to the first (or a default) format if the index is out of range
+  const CharFormat &charFormat(unsigned index) const;
+  const ParagraphFormat &paragraphFormat(unsigned index) const;
+};
+
+// consecutive runs of text with the same format, stored as struct of arrays
+struct TextRuns
+{
+  std::vector<uint32_t> formatIndexes;
+  std::vector<uint32_t> startIndexes;
+  std::vector<uint32_t> lengths;
+
+  TextRuns()
+    : formatIndexes(), startIndexes(), lengths()
+  { }
+
+  size_t size() const
   {
-    return startIndex + length - 1;
+    return formatIndexes.size();
   }
 
-  unsigned afterEndIndex() const
+  bool empty() const
   {
-    return startIndex + length;
+    return formatIndexes.empty();
   }
 
-  bool overlaps(const TextSpec &other) const;
+  void append(uint32_t formatIndex, uint32_t length);
+  void reserve(size_t count);
 
-protected:
-  TextSpec(unsigned start, unsigned len)
-    : startIndex(start), length(len)
-  { }
-};
+  uint32_t startIndex(size_t run) const
+  {
+    return startIndexes[run];
+  }
 
-struct CharFormatSpec : public TextSpec
-{
-  std::shared_ptr<CharFormat> format;
+  uint32_t length(size_t run) const
+  {
+    return lengths[run];
+  }
 
-  CharFormatSpec(const std::shared_ptr<CharFormat> &f, unsigned start, unsigned len)
-    : TextSpec(start, len), format(f)
-  { }
+  uint32_t endIndex(size_t run) const
+  {
+    return startIndexes[run] + lengths[run] - 1;
+  }
+
+  uint32_t afterEndIndex(size_t run) const
+  {
+    return startIndexes[run] + lengths[run];
+  }
+
+  // index after the last run
+  uint32_t afterEndIndex() const
+  {
+    return empty() ? 0 : afterEndIndex(size() - 1);
+  }
 };
 
-struct ParagraphSpec : public TextSpec
+struct ParagraphMetrics
 {
-  std::shared_ptr<ParagraphFormat> format;
+  unsigned firstCharFormat; // index of the first char format that overlaps the paragraph
+  unsigned charFormatsCount; // number of char formats that overlap the paragraph
+  double maxFontSize;
 
-  ParagraphSpec(const std::shared_ptr<ParagraphFormat> &f, unsigned start, unsigned len)
-    : TextSpec(start, len), format(f)
+  ParagraphMetrics()
+    : firstCharFormat(0), charFormatsCount(0), maxFontSize(0)
   { }
 };
 
@@ -317,18 +353,29 @@ struct Text
 {
   std::string text;
   const char *encoding;
-  std::vector<ParagraphSpec> paragraphs;
-  std::vector<CharFormatSpec> charFormats;
+  std::shared_ptr<const TextFormats> formats;
+  TextRuns paragraphs;
+  TextRuns charFormats;
+  std::vector<ParagraphMetrics> paragraphMetrics; // parallel to paragraphs
+
+  const CharFormat &charFormat(size_t run) const;
+  const ParagraphFormat &paragraphFormat(size_t run) const;
+
+  // must be called after paragraphs or char formats are changed
+  void updateMetrics();
 
   double maxFontSize() const;
-  double maxFontSize(const ParagraphSpec &paragraph) const;
+  double maxFontSize(unsigned paragraph) const;
 
   Text()
-    : text(), encoding("cp1252"), paragraphs(), charFormats()
+    : text(), encoding("cp1252"), formats(), paragraphs(), charFormats(), paragraphMetrics(), m_maxFontSize(0)
   { }
 
   Text(const Text &other) = default;
   Text &operator=(const Text &other) = default;
+
+private:
+  double m_maxFontSize;
 };
 
 struct Arrow
@@ -0,0 +1,73 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPWorkerPool.h"
+
+#include <algorithm>
+
+namespace libqxp
+{
+
+QXPWorkerPool::QXPWorkerPool(const unsigned threads)
+  : m_mutex()
+  , m_changed()
+  , m_tasks()
+  , m_stopping(false)
+  , m_threads()
+{
+  const unsigned count = std::max(threads, 1u);
+  m_threads.reserve(count);
+  for (unsigned i = 0; i != count; ++i)
+    m_threads.emplace_back(&QXPWorkerPool::work, this);
+}
+
+QXPWorkerPool::~QXPWorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_changed.notify_all();
+  for (auto &thread : m_threads)
+    thread.join();
+}
+
+void QXPWorkerPool::enqueue(std::function<void()> task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+  m_changed.notify_one();
+}
+
+void QXPWorkerPool::work()
+{
+  while (true)
+  {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_changed.wait(lock, [this]
+      {
+        return m_stopping || !m_tasks.empty();
+      });
+      if (m_tasks.empty())
+        return;
+      task = std::move(m_tasks.front());
+      m_tasks.pop_front();
+    }
+    // exceptions end up in the future of the task
+    task();
+  }
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,68 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPWORKERPOOL_H_INCLUDED
+#define QXPWORKERPOOL_H_INCLUDED
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libqxp
+{
+
+/** Fixed set of threads running submitted tasks in order of submission.
+  *
+  * Tasks still queued when the pool is destroyed are run before the
+  * threads are joined, so every returned future gets its result.
+  */
+class QXPWorkerPool
+{
+  // disable copying
+  QXPWorkerPool(const QXPWorkerPool &other) = delete;
+  QXPWorkerPool &operator=(const QXPWorkerPool &other) = delete;
+
+public:
+  explicit QXPWorkerPool(unsigned threads);
+  ~QXPWorkerPool();
+
+  template<typename F>
+  auto submit(F task) -> std::future<decltype(task())>
+  {
+    typedef decltype(task()) Result;
+    const auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    auto future = packaged->get_future();
+    enqueue([packaged]()
+    {
+      (*packaged)();
+    });
+    return future;
+  }
+
+private:
+  void enqueue(std::function<void()> task);
+  void work();
+
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::deque<std::function<void()>> m_tasks;
+  bool m_stopping;
+  std::vector<std::thread> m_threads;
+};
+
+}
+
+#endif // QXPWORKERPOOL_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
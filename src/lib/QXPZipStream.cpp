@@ -0,0 +1,381 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "QXPZipStream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <zlib.h>
+
+#include "QXPSubStream.h"
+#include "libqxp_utils.h"
+
+namespace libqxp
+{
+
+using librevenge::RVNGInputStream;
+using std::shared_ptr;
+
+namespace
+{
+
+const unsigned long CHUNK_SIZE = 0x10000;
+const unsigned long CACHE_CHUNKS = 256; // i.e., 16 MiB
+const unsigned long CHECKPOINT_INTERVAL = 0x100000;
+const unsigned long INPUT_SIZE = 0x4000;
+
+const uint32_t SIGNATURE_END_OF_DIRECTORY = 0x06054b50;
+const uint32_t SIGNATURE_DIRECTORY_ENTRY = 0x02014b50;
+const uint32_t SIGNATURE_LOCAL_HEADER = 0x04034b50;
+
+const unsigned END_OF_DIRECTORY_SIZE = 22;
+const unsigned MAX_COMMENT_SIZE = 0xffff;
+
+const unsigned METHOD_STORED = 0;
+const unsigned METHOD_DEFLATED = 8;
+
+uint32_t getU32(const unsigned char *const data)
+{
+  return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+unsigned long findEndOfDirectory(const shared_ptr<RVNGInputStream> &archive)
+{
+  archive->seek(0, librevenge::RVNG_SEEK_END);
+  const unsigned long length = static_cast<unsigned long>(archive->tell());
+  if (length < END_OF_DIRECTORY_SIZE)
+    throw UnsupportedFormat();
+  const unsigned long tailLength = std::min<unsigned long>(length, END_OF_DIRECTORY_SIZE + MAX_COMMENT_SIZE);
+  libqxp::seek(archive, length - tailLength);
+  const unsigned char *const tail = readNBytes(archive, tailLength);
+  for (unsigned long pos = tailLength - END_OF_DIRECTORY_SIZE + 1; pos > 0; --pos)
+  {
+    if (getU32(tail + pos - 1) == SIGNATURE_END_OF_DIRECTORY)
+      return length - tailLength + pos - 1;
+  }
+  throw UnsupportedFormat();
+}
+
+}
+
+struct QXPZipStream::Inflater
+{
+  z_stream stream;
+  unsigned long inPos;
+  unsigned long outPos;
+
+  Inflater()
+    : stream()
+    , inPos(0)
+    , outPos(0)
+  {
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+      throw GenericException();
+  }
+
+  explicit Inflater(Inflater &other)
+    : stream()
+    , inPos(other.inPos - other.stream.avail_in)
+    , outPos(other.outPos)
+  {
+    if (inflateCopy(&stream, &other.stream) != Z_OK)
+      throw GenericException();
+    // the saved state restarts reading at the first byte not consumed yet
+    stream.next_in = nullptr;
+    stream.avail_in = 0;
+  }
+
+  ~Inflater()
+  {
+    inflateEnd(&stream);
+  }
+};
+
+shared_ptr<RVNGInputStream> QXPZipStream::open(const shared_ptr<RVNGInputStream> &archive, const char *const name) try
+{
+  if (!archive || !name)
+    return shared_ptr<RVNGInputStream>();
+
+  const unsigned long endOfDirectory = findEndOfDirectory(archive);
+  libqxp::seek(archive, endOfDirectory + 10);
+  const unsigned entries = readU16(archive);
+  skip(archive, 4);
+  const unsigned long directory = readU32(archive);
+
+  libqxp::seek(archive, directory);
+  const size_t nameLength = std::strlen(name);
+  for (unsigned i = 0; i < entries; ++i)
+  {
+    if (readU32(archive) != SIGNATURE_DIRECTORY_ENTRY)
+      break;
+    skip(archive, 6);
+    const unsigned method = readU16(archive);
+    skip(archive, 8);
+    const uint32_t compressedSize = readU32(archive);
+    const uint32_t size = readU32(archive);
+    const unsigned entryNameLength = readU16(archive);
+    const unsigned extraLength = readU16(archive);
+    const unsigned commentLength = readU16(archive);
+    skip(archive, 8);
+    const uint32_t localHeader = readU32(archive);
+    const unsigned char *const entryName = readNBytes(archive, entryNameLength);
+    if (entryNameLength != nameLength || std::memcmp(entryName, name, nameLength) != 0)
+    {
+      skip(archive, extraLength + commentLength);
+      continue;
+    }
+
+    if (compressedSize == 0xffffffff || size == 0xffffffff || localHeader == 0xffffffff)
+    {
+      QXP_DEBUG_MSG(("QXPZipStream::open: zip64 member %s is not supported\n", name));
+      return shared_ptr<RVNGInputStream>();
+    }
+    libqxp::seek(archive, localHeader);
+    if (readU32(archive) != SIGNATURE_LOCAL_HEADER)
+      return shared_ptr<RVNGInputStream>();
+    skip(archive, 22);
+    const unsigned localNameLength = readU16(archive);
+    const unsigned localExtraLength = readU16(archive);
+    const unsigned long offset = localHeader + 30 + localNameLength + localExtraLength;
+
+    switch (method)
+    {
+    case METHOD_STORED:
+      return std::make_shared<QXPSubStream>(archive, offset, size);
+    case METHOD_DEFLATED:
+      return std::make_shared<QXPZipStream>(archive, offset, compressedSize, size, CHUNK_SIZE, CACHE_CHUNKS, CHECKPOINT_INTERVAL);
+    default:
+      QXP_DEBUG_MSG(("QXPZipStream::open: unsupported compression method %u\n", method));
+      return shared_ptr<RVNGInputStream>();
+    }
+  }
+  return shared_ptr<RVNGInputStream>();
+}
+catch (...)
+{
+  return shared_ptr<RVNGInputStream>();
+}
+
+QXPZipStream::QXPZipStream(const shared_ptr<RVNGInputStream> &archive, const unsigned long offset, const unsigned long compressedSize, const unsigned long size,
+                           const unsigned long chunkSize, const unsigned long cacheChunks, const unsigned long checkpointInterval)
+  : m_archive(archive)
+  , m_offset(offset)
+  , m_compressedSize(compressedSize)
+  , m_size(size)
+  , m_chunkSize(std::max<unsigned long>(chunkSize, 1))
+  , m_cacheChunks(std::max<unsigned long>(cacheChunks, 1))
+  , m_checkpointInterval(std::max<unsigned long>(checkpointInterval / m_chunkSize, 1) * m_chunkSize)
+  , m_pos(0)
+  , m_inflater()
+  , m_checkpoints()
+  , m_cache()
+  , m_input()
+  , m_buffer()
+{
+}
+
+QXPZipStream::~QXPZipStream()
+{
+}
+
+bool QXPZipStream::isStructured()
+{
+  return false;
+}
+
+unsigned QXPZipStream::subStreamCount()
+{
+  return 0;
+}
+
+const char *QXPZipStream::subStreamName(unsigned)
+{
+  return 0;
+}
+
+bool QXPZipStream::existsSubStream(const char *)
+{
+  return false;
+}
+
+RVNGInputStream *QXPZipStream::getSubStreamByName(const char *)
+{
+  return 0;
+}
+
+RVNGInputStream *QXPZipStream::getSubStreamById(unsigned)
+{
+  return 0;
+}
+
+const unsigned char *QXPZipStream::read(unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+
+  const unsigned long pos = static_cast<unsigned long>(m_pos);
+  if ((0 == numBytes) || (pos >= m_size))
+    return 0;
+
+  numBytes = std::min(numBytes, m_size - pos);
+
+  const unsigned long offset = pos % m_chunkSize;
+  const std::vector<unsigned char> &first = getChunk(pos / m_chunkSize);
+  if (offset + numBytes <= first.size())
+  {
+    m_pos += long(numBytes);
+    numBytesRead = numBytes;
+    return first.data() + offset;
+  }
+
+  // the range spans several chunks
+  m_buffer.resize(numBytes);
+  unsigned long copied = 0;
+  while (copied < numBytes)
+  {
+    const unsigned long current = pos + copied;
+    const std::vector<unsigned char> &chunk = getChunk(current / m_chunkSize);
+    const unsigned long start = current % m_chunkSize;
+    const unsigned long length = std::min(numBytes - copied, chunk.size() - start);
+    std::copy(chunk.begin() + long(start), chunk.begin() + long(start + length), m_buffer.begin() + long(copied));
+    copied += length;
+  }
+  m_pos += long(numBytes);
+  numBytesRead = numBytes;
+  return m_buffer.data();
+}
+catch (...)
+{
+  return 0;
+}
+
+int QXPZipStream::seek(const long offset, librevenge::RVNG_SEEK_TYPE seekType)
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + m_pos;
+    break;
+  case librevenge::RVNG_SEEK_END :
+    pos = offset + long(m_size);
+    break;
+  default :
+    return -1;
+  }
+
+  if ((pos < 0) || (pos > long(m_size)))
+    return 1;
+
+  m_pos = pos;
+  return 0;
+}
+
+long QXPZipStream::tell()
+{
+  return m_pos;
+}
+
+bool QXPZipStream::isEnd()
+{
+  return long(m_size) == m_pos;
+}
+
+const std::vector<unsigned char> &QXPZipStream::getChunk(const unsigned long index)
+{
+  for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
+  {
+    if (it->first == index)
+    {
+      if (it != m_cache.begin())
+        m_cache.splice(m_cache.begin(), m_cache, it);
+      return m_cache.front().second;
+    }
+  }
+
+  const unsigned long start = index * m_chunkSize;
+  if (!m_inflater || m_inflater->outPos > start)
+    restore(start);
+
+  // checkpoints are only needed if chunks can be dropped from the cache
+  const bool saveCheckpoints = m_size > m_cacheChunks * m_chunkSize;
+  std::vector<unsigned char> chunk;
+  while (true)
+  {
+    const bool wanted = m_inflater->outPos == start;
+    chunk.resize(std::min(m_chunkSize, m_size - m_inflater->outPos));
+    inflateChunk(chunk);
+    if (saveCheckpoints && (m_inflater->outPos % m_checkpointInterval == 0) && (m_inflater->outPos < m_size)
+        && (m_checkpoints.empty() || m_checkpoints.back()->outPos < m_inflater->outPos))
+      m_checkpoints.push_back(make_unique<Inflater>(*m_inflater));
+    if (wanted)
+      break;
+  }
+
+  if (m_cache.size() >= m_cacheChunks)
+    m_cache.pop_back();
+  m_cache.emplace_front(index, std::vector<unsigned char>());
+  m_cache.front().second.swap(chunk);
+  return m_cache.front().second;
+}
+
+void QXPZipStream::restore(const unsigned long pos)
+{
+  auto it = std::upper_bound(m_checkpoints.begin(), m_checkpoints.end(), pos,
+                             [](const unsigned long p, const std::unique_ptr<Inflater> &checkpoint)
+  {
+    return p < checkpoint->outPos;
+  });
+  if (it == m_checkpoints.begin())
+    m_inflater = make_unique<Inflater>();
+  else
+    m_inflater = make_unique<Inflater>(**(it - 1));
+}
+
+void QXPZipStream::inflateChunk(std::vector<unsigned char> &chunk)
+{
+  z_stream &stream = m_inflater->stream;
+  stream.next_out = chunk.data();
+  stream.avail_out = uInt(chunk.size());
+  while (stream.avail_out > 0)
+  {
+    if (stream.avail_in == 0)
+    {
+      if (m_inflater->inPos >= m_compressedSize)
+        throw ParseError();
+      const unsigned long length = std::min(INPUT_SIZE, m_compressedSize - m_inflater->inPos);
+      libqxp::seek(m_archive, m_offset + m_inflater->inPos);
+      const unsigned char *const data = readNBytes(m_archive, length);
+      m_input.assign(data, data + length);
+      stream.next_in = m_input.data();
+      stream.avail_in = uInt(length);
+      m_inflater->inPos += length;
+    }
+    const int ret = inflate(&stream, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END)
+    {
+      if (stream.avail_out != 0)
+        throw ParseError();
+      break;
+    }
+    if (ret != Z_OK)
+    {
+      QXP_DEBUG_MSG(("QXPZipStream::inflateChunk: inflate failed with %d\n", ret));
+      throw ParseError();
+    }
+  }
+  m_inflater->outPos += chunk.size();
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,94 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPZIPSTREAM_H_INCLUDED
+#define QXPZIPSTREAM_H_INCLUDED
+
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+namespace libqxp
+{
+
+/** A deflated zip archive member, inflated on demand.
+  *
+  * The member is decoded in chunks, and only a bounded number of them
+  * is kept in memory. To make seeking backwards cheap, the inflater
+  * state is saved at regular intervals, so a chunk that has been
+  * dropped from the cache is decoded again from the nearest saved
+  * state instead of from the start of the member.
+  *
+  * If the whole member fits in the cache, no states are saved and the
+  * stream behaves like a fully inflated copy.
+  */
+class QXPZipStream : public librevenge::RVNGInputStream
+{
+// disable copying
+  QXPZipStream(const QXPZipStream &other) = delete;
+  QXPZipStream &operator=(const QXPZipStream &other) = delete;
+
+  struct Inflater;
+
+public:
+  /** Opens member @c name of zip archive @c archive.
+    *
+    * A stored member is returned as a plain view of the archive.
+    *
+    * @return the member stream, or an empty pointer if @c archive is
+    * not a zip archive, it has no member @c name or the member cannot
+    * be read by this class (e.g., zip64 or unsupported compression).
+    */
+  static std::shared_ptr<librevenge::RVNGInputStream> open(const std::shared_ptr<librevenge::RVNGInputStream> &archive, const char *name);
+
+  QXPZipStream(const std::shared_ptr<librevenge::RVNGInputStream> &archive, unsigned long offset, unsigned long compressedSize, unsigned long size,
+               unsigned long chunkSize, unsigned long cacheChunks, unsigned long checkpointInterval);
+  ~QXPZipStream() override;
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  const std::vector<unsigned char> &getChunk(unsigned long index);
+  void restore(unsigned long pos);
+  void inflateChunk(std::vector<unsigned char> &chunk);
+
+  const std::shared_ptr<librevenge::RVNGInputStream> m_archive;
+  const unsigned long m_offset;
+  const unsigned long m_compressedSize;
+  const unsigned long m_size;
+  const unsigned long m_chunkSize;
+  const unsigned long m_cacheChunks;
+  const unsigned long m_checkpointInterval;
+  long m_pos;
+
+  std::unique_ptr<Inflater> m_inflater;
+  std::vector<std::unique_ptr<Inflater>> m_checkpoints;
+  std::list<std::pair<unsigned long, std::vector<unsigned char>>> m_cache;
+  std::vector<unsigned char> m_input;
+  std::vector<unsigned char> m_buffer;
+};
+
+}
+
+#endif // QXPZIPSTREAM_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
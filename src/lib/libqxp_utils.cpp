@@ -9,6 +9,8 @@
 
 #include "libqxp_utils.h"
 
+#include <libqxp/QXPParseOptions.h>
+
 #include <unicode/ucnv.h>
 #include <unicode/utypes.h>
 
@@ -17,6 +19,8 @@
 #include <cstdio>
 #endif
 
+#include <cstring>
+
 #include <boost/math/constants/constants.hpp>
 
 using std::string;
@@ -83,6 +87,38 @@ static void _appendUCS4(librevenge::RVNGString &text, unsigned ucs4Character)
     text.append(char(outbuf[i]));
 }
 
+void flushText(librevenge::RVNGDrawingInterface *painter, std::string &text)
+{
+  if (!text.empty())
+  {
+    painter->insertText(librevenge::RVNGString(text.c_str()));
+    text.clear();
+  }
+}
+
+bool isControlChar(const char c)
+{
+  return static_cast<unsigned char>(c) < 0x20;
+}
+
+// Finds the first byte < 0x20, checking 8 bytes at a time.
+const char *findControlChar(const char *begin, const char *const end)
+{
+  const uint64_t ones = 0x0101010101010101ull;
+  const uint64_t highBits = 0x8080808080808080ull;
+  while (end - begin >= 8)
+  {
+    uint64_t word;
+    std::memcpy(&word, begin, sizeof(word));
+    // nonzero iff some byte is < 0x20; bytes >= 0x80 are never matched
+    if ((word - 0x20 * ones) & ~word & highBits)
+      break;
+    begin += 8;
+  }
+  while (begin != end && !isControlChar(*begin))
+    ++begin;
+  return begin;
+}
 
 }
 
@@ -371,6 +407,16 @@ EndOfStreamException::EndOfStreamException()
   QXP_DEBUG_MSG(("Throwing EndOfStreamException\n"));
 }
 
+void checkParseLimits(const QXPParseOptions *const options)
+{
+  if (!options)
+    return;
+  if (options->isCancelled())
+    throw ParseCancelled();
+  if (options->isPastDeadline())
+    throw DeadlineExceeded();
+}
+
 double deg2rad(double value)
 {
   using namespace boost::math::double_constants;
@@ -423,6 +469,62 @@ void appendCharacters(librevenge::RVNGString &text, const char *characters, cons
   }
 }
 
+void insertText(librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGString &text)
+{
+  // TODO: need to remember wasSpace on span change?
+  bool wasSpace = false;
+  std::string curText;
+
+  const char *p = text.cstr();
+  const char *const end = p + text.size();
+  while (p != end)
+  {
+    // between control chars only the second and following spaces of a run need special handling
+    const char *const controlChar = findControlChar(p, end);
+    const char *runStart = p;
+    for (const char *space = p; space != controlChar; ++space)
+    {
+      space = static_cast<const char *>(std::memchr(space, ' ', size_t(controlChar - space)));
+      if (!space)
+        break;
+      if (space == p ? wasSpace : space[-1] == ' ')
+      {
+        curText.append(runStart, space);
+        flushText(painter, curText);
+        painter->insertSpace();
+        runStart = space + 1;
+      }
+    }
+    curText.append(runStart, controlChar);
+    if (controlChar != p)
+      wasSpace = controlChar[-1] == ' ';
+
+    if (controlChar == end)
+      break;
+
+    wasSpace = false;
+    switch (*controlChar)
+    {
+    case '\r':
+      break;
+    case '\n':
+      flushText(painter, curText);
+      painter->insertLineBreak();
+      break;
+    case '\t':
+      flushText(painter, curText);
+      painter->insertTab();
+      break;
+    default:
+      QXP_DEBUG_MSG(("insertText[QPXContentCollector.cpp]: bad character=%x\n",unsigned(*controlChar)));
+      break;
+    }
+    p = controlChar + 1;
+  }
+
+  flushText(painter, curText);
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
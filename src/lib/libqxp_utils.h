@@ -123,6 +123,9 @@ double normalizeRadAngle(double radAngle);
 void appendCharacters(librevenge::RVNGString &text, const char *characters, const size_t size,
                       const char *encoding);
 
+// inserts UTF-8 text, turning tabs, line breaks and second and further spaces of a run into their own calls
+void insertText(librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGString &text);
+
 class EndOfStreamException
 {
 public:
@@ -147,6 +150,25 @@ class UnsupportedFormat
 {
 };
 
+// the parse has to stop before its end, as asked by QXPParseOptions
+
+class ParseInterrupted
+{
+};
+
+class ParseCancelled : public ParseInterrupted
+{
+};
+
+class DeadlineExceeded : public ParseInterrupted
+{
+};
+
+class QXPParseOptions;
+
+// throws ParseCancelled or DeadlineExceeded if the parse has to stop; options may be null
+void checkParseLimits(const QXPParseOptions *options);
+
 } // namespace libqxp
 
 #endif // INCLUDED_LIBQXP_UTILS_H
@@ -125,6 +125,7 @@ void QXPBlockParserTest::testGetDocChain()
     auto parser = createParser(name);
     auto stream = parser->getChain(3);
     CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expectedSize, getRemainingLength(stream));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expectedSize, parser->getChainLength(3));
   }
 }
 
@@ -0,0 +1,222 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/QXPMemoryStats.h>
+
+#include "QXPBlockParser.h"
+#include "QXPChainStream.h"
+#include "QXPDetector.h"
+#include "QXPHeader.h"
+
+#if !defined TEST_DATA_DIR
+#error TEST_DATA_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libqxp::QXPBlockParser;
+using libqxp::QXPChainStream;
+using libqxp::QXPDetector;
+using libqxp::QXPMemoryStats;
+
+using librevenge::RVNGInputStream;
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace
+{
+
+const char *const DOCUMENTS[] =
+{
+  "qxp33mac_text",
+  "qxp33win_text.qxd",
+  "qxp33mac_pages",
+  "qxp4mac_text",
+  "qxp4win_text.qxd",
+  "qxp4win_pages.qxd",
+};
+
+shared_ptr<QXPBlockParser> createParser(const string &name)
+{
+  const shared_ptr<RVNGInputStream> input(new librevenge::RVNGFileStream((string(TEST_DATA_DIR) + "/" + name).c_str()));
+  QXPDetector detector;
+  detector.detect(input);
+  CPPUNIT_ASSERT(detector.header());
+  CPPUNIT_ASSERT(detector.input());
+  CPPUNIT_ASSERT(detector.header()->load(detector.input()));
+  return make_shared<QXPBlockParser>(detector.input(), detector.header());
+}
+
+vector<unsigned char> readChain(QXPBlockParser &parser)
+{
+  const shared_ptr<RVNGInputStream> chain = parser.getChain(3);
+  CPPUNIT_ASSERT(bool(chain));
+  const unsigned long length = parser.getChainLength(3);
+  unsigned long numBytesRead = 0;
+  const unsigned char *const data = chain->read(length, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(length, numBytesRead);
+  return vector<unsigned char>(data, data + length);
+}
+
+}
+
+class QXPChainStreamTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPChainStreamTest);
+  CPPUNIT_TEST(testRead);
+  CPPUNIT_TEST(testRandomAccess);
+  CPPUNIT_TEST(testSeek);
+  CPPUNIT_TEST(testMemory);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRead();
+  void testRandomAccess();
+  void testSeek();
+  void testMemory();
+};
+
+void QXPChainStreamTest::setUp()
+{
+}
+
+void QXPChainStreamTest::tearDown()
+{
+}
+
+void QXPChainStreamTest::testRead()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    const auto parser = createParser(name);
+    const vector<unsigned char> expected = readChain(*parser);
+
+    // in small pieces, as the parser reads it
+    QXPChainStream stream(*parser, 3, make_shared<std::mutex>());
+    vector<unsigned char> content;
+    while (!stream.isEnd())
+    {
+      unsigned long numBytesRead = 0;
+      const unsigned char *const data = stream.read(7, numBytesRead);
+      CPPUNIT_ASSERT_MESSAGE(name, data);
+      CPPUNIT_ASSERT_MESSAGE(name, numBytesRead > 0);
+      content.insert(content.end(), data, data + numBytesRead);
+    }
+    CPPUNIT_ASSERT_MESSAGE(name, expected == content);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, long(expected.size()), stream.tell());
+
+    // at once
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0, stream.seek(0, librevenge::RVNG_SEEK_SET));
+    unsigned long numBytesRead = 0;
+    const unsigned char *const data = stream.read(expected.size() + 100, numBytesRead);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, (unsigned long)expected.size(), numBytesRead);
+    CPPUNIT_ASSERT_MESSAGE(name, std::equal(expected.begin(), expected.end(), data));
+    CPPUNIT_ASSERT_MESSAGE(name, !stream.read(1, numBytesRead));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0ul, numBytesRead);
+  }
+}
+
+void QXPChainStreamTest::testRandomAccess()
+{
+  std::srand(49);
+  for (const auto name : DOCUMENTS)
+  {
+    const auto parser = createParser(name);
+    const vector<unsigned char> expected = readChain(*parser);
+    const unsigned long size = expected.size();
+
+    QXPChainStream stream(*parser, 3, make_shared<std::mutex>());
+    // backwards and forwards, across the ends of blocks
+    for (int i = 0; i < 200; ++i)
+    {
+      const unsigned long pos = static_cast<unsigned long>(std::rand()) % size;
+      const unsigned long length = std::min(static_cast<unsigned long>(std::rand()) % 1000 + 1, size - pos);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0, stream.seek(long(pos), librevenge::RVNG_SEEK_SET));
+      unsigned long numBytesRead = 0;
+      const unsigned char *const data = stream.read(length, numBytesRead);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, length, numBytesRead);
+      CPPUNIT_ASSERT_MESSAGE(name, std::equal(data, data + length, expected.begin() + long(pos)));
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, long(pos + length), stream.tell());
+    }
+  }
+}
+
+void QXPChainStreamTest::testSeek()
+{
+  const auto parser = createParser("qxp4win_pages.qxd");
+  const unsigned long size = parser->getChainLength(3);
+
+  QXPChainStream stream(*parser, 3, make_shared<std::mutex>());
+  CPPUNIT_ASSERT(!stream.isStructured());
+  CPPUNIT_ASSERT(!stream.isEnd());
+  CPPUNIT_ASSERT_EQUAL(0, stream.seek(0, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT_EQUAL(long(size), stream.tell());
+  CPPUNIT_ASSERT(stream.isEnd());
+
+  CPPUNIT_ASSERT_EQUAL(0, stream.seek(-10, librevenge::RVNG_SEEK_CUR));
+  unsigned long numBytesRead = 0;
+  CPPUNIT_ASSERT(stream.read(100, numBytesRead));
+  CPPUNIT_ASSERT_EQUAL(10ul, numBytesRead);
+
+  // failed seeks do not move the position
+  CPPUNIT_ASSERT(stream.seek(long(size) + 1, librevenge::RVNG_SEEK_SET) != 0);
+  CPPUNIT_ASSERT(stream.seek(1, librevenge::RVNG_SEEK_END) != 0);
+  CPPUNIT_ASSERT(stream.seek(-1, librevenge::RVNG_SEEK_SET) != 0);
+  CPPUNIT_ASSERT_EQUAL(long(size), stream.tell());
+
+  // seeking forward walks the chain only as far as needed
+  QXPChainStream fresh(*parser, 3, make_shared<std::mutex>());
+  CPPUNIT_ASSERT_EQUAL(0, fresh.seek(long(size), librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT(fresh.isEnd());
+}
+
+void QXPChainStreamTest::testMemory()
+{
+  const auto parser = createParser("qxp4win_pages.qxd");
+  const unsigned long size = parser->getChainLength(3);
+
+  QXPMemoryStats stats;
+  {
+    QXPChainStream stream(*parser, 3, make_shared<std::mutex>(), &stats);
+    while (!stream.isEnd())
+    {
+      unsigned long numBytesRead = 0;
+      CPPUNIT_ASSERT(stream.read(16, numBytesRead));
+    }
+    // only a window of the chain is held, not all of it
+    CPPUNIT_ASSERT(stats.usage(QXPMemoryStats::CATEGORY_STREAMS).current > 0);
+    CPPUNIT_ASSERT(stats.usage(QXPMemoryStats::CATEGORY_STREAMS).current < size);
+  }
+  CPPUNIT_ASSERT_EQUAL(0ul, stats.usage(QXPMemoryStats::CATEGORY_STREAMS).current);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPChainStreamTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
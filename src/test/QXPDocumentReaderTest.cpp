@@ -0,0 +1,194 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <memory>
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/QXPDocumentReader.h>
+
+#include "QXPDetector.h"
+#include "QXPDrawingRecorder.h"
+#include "QXPHeader.h"
+#include "QXPParser.h"
+#include "QXPTracingPainter.h"
+
+#if !defined TEST_DATA_DIR
+#error TEST_DATA_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libqxp::QXPDetector;
+using libqxp::QXPDocument;
+using libqxp::QXPDocumentReader;
+using libqxp::QXPDrawingRecorder;
+
+using std::shared_ptr;
+using std::string;
+
+namespace
+{
+
+const char *const DOCUMENTS[] =
+{
+  "qxp1.zip",
+  "qxp31mac",
+  "qxp31win.qxd",
+  "qxp33mac",
+  "qxp33mac_text",
+  "qxp33win.qxd",
+  "qxp33win_text.qxd",
+  "qxp4mac",
+  "qxp4mac_text",
+  "qxp4win.qxd",
+  "qxp4win_text.qxd",
+};
+
+const char *const MULTI_PAGE_DOCUMENTS[] =
+{
+  "qxp33mac_pages",
+  "qxp4win_pages.qxd",
+};
+
+string path(const string &name)
+{
+  return string(TEST_DATA_DIR) + "/" + name;
+}
+
+unsigned countPages(const string &name)
+{
+  QXPDetector detector;
+  detector.detect(shared_ptr<librevenge::RVNGInputStream>(new librevenge::RVNGFileStream(path(name).c_str())));
+  CPPUNIT_ASSERT_MESSAGE(name, detector.isSupported());
+  QXPDrawingRecorder painter;
+  const auto parser = detector.header()->createParser(detector.input(), &painter);
+  CPPUNIT_ASSERT_MESSAGE(name, parser->parse());
+  return painter.completePages();
+}
+
+// the calls from the first startPage to the last endPage
+string pagesOf(const string &trace)
+{
+  const string endPage("endPage()\n");
+  const auto begin = trace.find("startPage(");
+  const auto end = trace.rfind(endPage);
+  CPPUNIT_ASSERT(begin != string::npos);
+  CPPUNIT_ASSERT(end != string::npos);
+  return trace.substr(begin, end + endPage.size() - begin);
+}
+
+}
+
+class QXPDocumentReaderTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPDocumentReaderTest);
+  CPPUNIT_TEST(testPages);
+  CPPUNIT_TEST(testMultiPage);
+  CPPUNIT_TEST(testUnsupported);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testPages();
+  void testMultiPage();
+  void testUnsupported();
+};
+
+void QXPDocumentReaderTest::setUp()
+{
+}
+
+void QXPDocumentReaderTest::tearDown()
+{
+}
+
+void QXPDocumentReaderTest::testPages()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    const unsigned expected = countPages(name);
+    CPPUNIT_ASSERT_MESSAGE(name, expected > 0);
+
+    librevenge::RVNGFileStream input(path(name).c_str());
+    QXPDocumentReader reader;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, reader.open(&input));
+
+    unsigned pages = 0;
+    while (!reader.isDone())
+    {
+      // every page is a document of its own
+      QXPDrawingRecorder painter;
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, reader.nextPage(&painter));
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 1u, painter.completePages());
+      ++pages;
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expected, pages);
+
+    // nothing is left
+    QXPDrawingRecorder painter;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, reader.nextPage(&painter));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, painter.completePages());
+  }
+}
+
+void QXPDocumentReaderTest::testMultiPage()
+{
+  for (const auto name : MULTI_PAGE_DOCUMENTS)
+  {
+    QXPTracingPainter whole;
+    {
+      librevenge::RVNGFileStream input(path(name).c_str());
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::parse(&input, &whole));
+    }
+    CPPUNIT_ASSERT_MESSAGE(name, whole.pages > 1);
+
+    librevenge::RVNGFileStream input(path(name).c_str());
+    QXPDocumentReader reader;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, reader.open(&input));
+    string pages;
+    while (!reader.isDone())
+    {
+      QXPTracingPainter painter;
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, reader.nextPage(&painter));
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 1u, painter.pages);
+      // every page is a document of its own, so only the pages are compared
+      pages += pagesOf(painter.trace);
+    }
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, pagesOf(whole.trace), pages);
+  }
+}
+
+void QXPDocumentReaderTest::testUnsupported()
+{
+  QXPDocumentReader reader;
+  CPPUNIT_ASSERT(reader.isDone());
+
+  librevenge::RVNGFileStream input(path("qxp5.qxd").c_str());
+  CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_UNSUPPORTED_FORMAT, reader.open(&input));
+  CPPUNIT_ASSERT(reader.isDone());
+
+  QXPDrawingRecorder painter;
+  CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_OK, reader.nextPage(&painter));
+  CPPUNIT_ASSERT_EQUAL(0u, painter.completePages());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPDocumentReaderTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
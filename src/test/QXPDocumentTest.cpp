@@ -8,6 +8,8 @@
  */
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -24,8 +26,11 @@ namespace test
 {
 
 using libqxp::QXPDocument;
+using libqxp::QXPInventory;
+using libqxp::QXPTextSink;
 
 using std::string;
+using std::vector;
 
 namespace
 {
@@ -50,6 +55,22 @@ void assertUnsupported(const string &name)
   assertDetection(name, false);
 }
 
+class StoryCollector : public QXPTextSink
+{
+public:
+  StoryCollector()
+    : stories()
+  {
+  }
+
+  void insertStory(const char *text, unsigned long length) override
+  {
+    stories.push_back(string(text, length));
+  }
+
+  vector<string> stories;
+};
+
 }
 
 class QXPDocumentTest : public CPPUNIT_NS::TestFixture
@@ -62,11 +83,17 @@ private:
   CPPUNIT_TEST_SUITE(QXPDocumentTest);
   CPPUNIT_TEST(testDetectQXP);
   CPPUNIT_TEST(testUnsupported);
+  CPPUNIT_TEST(testExtractText);
+  CPPUNIT_TEST(testInventory);
+  CPPUNIT_TEST(testGetInfo);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testDetectQXP();
   void testUnsupported();
+  void testExtractText();
+  void testInventory();
+  void testGetInfo();
 };
 
 void QXPDocumentTest::setUp()
@@ -95,6 +122,87 @@ void QXPDocumentTest::testUnsupported()
   assertUnsupported("qxp6.qxd");
 }
 
+void QXPDocumentTest::testExtractText()
+{
+  const string expectedText = "123" + string(252, 't') + "456";
+  const char *const files[] = { "qxp33mac_text", "qxp33win_text.qxd", "qxp4mac_text", "qxp4win_text.qxd" };
+
+  for (const auto &name : files)
+  {
+    librevenge::RVNGFileStream input((string(DETECTION_TEST_DIR) + "/" + name).c_str());
+    StoryCollector collector;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::extractText(&input, &collector));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, size_t(1), collector.stories.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expectedText, collector.stories[0]);
+  }
+}
+
+void QXPDocumentTest::testInventory()
+{
+  // the font the story is in
+  const std::pair<const char *, const char *> files[] =
+  {
+    { "qxp33mac_text", "Helvetica" },
+    { "qxp33win_text.qxd", "Arial" },
+    { "qxp4mac_text", "Arial-PL" },
+    { "qxp4win_text.qxd", "Arial" },
+  };
+
+  for (const auto &file : files)
+  {
+    const auto name = file.first;
+    librevenge::RVNGFileStream input((string(DETECTION_TEST_DIR) + "/" + name).c_str());
+    QXPInventory inventory;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::getInventory(&input, inventory));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 1u, inventory.pageCount);
+    CPPUNIT_ASSERT_MESSAGE(name, inventory.pageWidth > 0);
+    CPPUNIT_ASSERT_MESSAGE(name, inventory.pageHeight > 0);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 1u, inventory.storyCount);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 258ul, inventory.characterCount);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 1u, inventory.fonts.size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, string(file.second), string(inventory.fonts[0].cstr()));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, inventory.pictureCount);
+    CPPUNIT_ASSERT_MESSAGE(name, inventory.colors.size() > 0);
+  }
+}
+
+void QXPDocumentTest::testGetInfo()
+{
+  {
+    librevenge::RVNGFileStream input((string(DETECTION_TEST_DIR) + "/qxp4mac").c_str());
+    QXPDocument::Info info;
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_OK, QXPDocument::getInfo(&input, info));
+    CPPUNIT_ASSERT_EQUAL(0x41u, info.version);
+    CPPUNIT_ASSERT(info.bigEndian);
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::TYPE_DOCUMENT, info.type);
+    CPPUNIT_ASSERT_EQUAL(1u, info.pageCount);
+    CPPUNIT_ASSERT_EQUAL(string("macroman"), string(info.encoding));
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::WRAPPER_NONE, info.wrapper);
+  }
+  {
+    librevenge::RVNGFileStream input((string(DETECTION_TEST_DIR) + "/qxp1.zip").c_str());
+    QXPDocument::Info info;
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_OK, QXPDocument::getInfo(&input, info));
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::TYPE_DOCUMENT, info.type);
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::WRAPPER_ZIP, info.wrapper);
+  }
+  {
+    librevenge::RVNGFileStream input((string(DETECTION_TEST_DIR) + "/qxp33win.qxd").c_str());
+    QXPDocument::Info info;
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_OK, QXPDocument::getInfo(&input, info));
+    CPPUNIT_ASSERT_EQUAL(0x3fu, info.version);
+    CPPUNIT_ASSERT(!info.bigEndian);
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::TYPE_DOCUMENT, info.type);
+    CPPUNIT_ASSERT_EQUAL(1u, info.pageCount);
+    CPPUNIT_ASSERT_EQUAL(string("cp1252"), string(info.encoding));
+  }
+  {
+    librevenge::RVNGFileStream input((string(DETECTION_TEST_DIR) + "/qxp6.qxd").c_str());
+    QXPDocument::Info info;
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_UNSUPPORTED_FORMAT, QXPDocument::getInfo(&input, info));
+  }
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(QXPDocumentTest);
 
 }
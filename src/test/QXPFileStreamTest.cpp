@@ -0,0 +1,234 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/QXPDocument.h>
+#include <libqxp/QXPFileStream.h>
+#include <libqxp/QXPParseOptions.h>
+
+#include "libqxp_utils.h"
+
+#include "QXPTracingPainter.h"
+
+#if !defined TEST_DATA_DIR
+#error TEST_DATA_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libqxp::QXPDocument;
+using libqxp::QXPFileStream;
+using libqxp::QXPParseOptions;
+using libqxp::getRemainingLength;
+
+using librevenge::RVNGInputStream;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace
+{
+
+const char *const MULTI_PAGE_DOCUMENTS[] =
+{
+  "qxp33mac_pages",
+  "qxp4win_pages.qxd",
+};
+
+string path(const string &name)
+{
+  return string(TEST_DATA_DIR) + "/" + name;
+}
+
+vector<unsigned char> readAll(RVNGInputStream &stream)
+{
+  stream.seek(0, librevenge::RVNG_SEEK_END);
+  const unsigned long length = static_cast<unsigned long>(stream.tell());
+  stream.seek(0, librevenge::RVNG_SEEK_SET);
+  unsigned long numBytesRead = 0;
+  const unsigned char *const data = stream.read(length, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(length, numBytesRead);
+  return vector<unsigned char>(data, data + length);
+}
+
+class RecordingFileStream : public QXPFileStream
+{
+public:
+  explicit RecordingFileStream(const char *const filename)
+    : QXPFileStream(filename)
+    , ranges()
+  {
+  }
+
+  void willNeed(const unsigned long offset, const unsigned long length) const override
+  {
+    ranges.push_back(pair<unsigned long, unsigned long>(offset, length));
+    QXPFileStream::willNeed(offset, length);
+  }
+
+  mutable vector<pair<unsigned long, unsigned long>> ranges;
+};
+
+}
+
+class QXPFileStreamTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPFileStreamTest);
+  CPPUNIT_TEST(testRead);
+  CPPUNIT_TEST(testRandomAccess);
+  CPPUNIT_TEST(testMissingFile);
+  CPPUNIT_TEST(testStructured);
+  CPPUNIT_TEST(testReadAhead);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRead();
+  void testRandomAccess();
+  void testMissingFile();
+  void testStructured();
+  void testReadAhead();
+};
+
+void QXPFileStreamTest::setUp()
+{
+}
+
+void QXPFileStreamTest::tearDown()
+{
+}
+
+void QXPFileStreamTest::testRead()
+{
+  librevenge::RVNGFileStream expected(path("qxp6.qxd").c_str());
+  QXPFileStream stream(path("qxp6.qxd").c_str());
+  CPPUNIT_ASSERT(readAll(expected) == readAll(stream));
+  CPPUNIT_ASSERT(stream.isEnd());
+
+  // reads stop at the end
+  CPPUNIT_ASSERT_EQUAL(0, stream.seek(-10, librevenge::RVNG_SEEK_END));
+  unsigned long numBytesRead = 0;
+  CPPUNIT_ASSERT(stream.read(100, numBytesRead));
+  CPPUNIT_ASSERT_EQUAL(10ul, numBytesRead);
+  CPPUNIT_ASSERT(!stream.read(1, numBytesRead));
+  CPPUNIT_ASSERT_EQUAL(0ul, numBytesRead);
+
+  CPPUNIT_ASSERT(stream.seek(1, librevenge::RVNG_SEEK_END) != 0);
+  CPPUNIT_ASSERT(stream.seek(-1, librevenge::RVNG_SEEK_SET) != 0);
+  CPPUNIT_ASSERT(stream.isEnd());
+}
+
+void QXPFileStreamTest::testRandomAccess()
+{
+  librevenge::RVNGFileStream input(path("qxp6.qxd").c_str());
+  const vector<unsigned char> expected = readAll(input);
+  const unsigned long size = expected.size();
+
+  QXPFileStream stream(path("qxp6.qxd").c_str());
+  // backwards and forwards, so the buffer is read again
+  const unsigned long positions[] = {30000, 0, 57000, 29999, 100, 57343, 4096, 4095, 256};
+  for (const auto pos : positions)
+  {
+    CPPUNIT_ASSERT_EQUAL(0, stream.seek(long(pos), librevenge::RVNG_SEEK_SET));
+    const unsigned long length = std::min(600ul, size - pos);
+    unsigned long numBytesRead = 0;
+    const unsigned char *const data = stream.read(length, numBytesRead);
+    CPPUNIT_ASSERT_EQUAL(length, numBytesRead);
+    CPPUNIT_ASSERT(std::equal(data, data + length, expected.begin() + long(pos)));
+    CPPUNIT_ASSERT_EQUAL(long(pos + length), stream.tell());
+
+    // hints do not move the position
+    stream.willNeed(0, size);
+    CPPUNIT_ASSERT_EQUAL(long(pos + length), stream.tell());
+  }
+}
+
+void QXPFileStreamTest::testMissingFile()
+{
+  QXPFileStream stream(path("nonexistent").c_str());
+  CPPUNIT_ASSERT(stream.isEnd());
+  CPPUNIT_ASSERT(!stream.isStructured());
+  unsigned long numBytesRead = 1;
+  CPPUNIT_ASSERT(!stream.read(1, numBytesRead));
+  CPPUNIT_ASSERT_EQUAL(0ul, numBytesRead);
+  stream.willNeed(0, 256);
+  CPPUNIT_ASSERT(!QXPDocument::isSupported(&stream));
+}
+
+void QXPFileStreamTest::testStructured()
+{
+  QXPFileStream stream(path("qxp1.zip").c_str());
+  CPPUNIT_ASSERT(stream.isStructured());
+  CPPUNIT_ASSERT(stream.existsSubStream("qxp1"));
+  const shared_ptr<RVNGInputStream> member(stream.getSubStreamByName("qxp1"));
+  CPPUNIT_ASSERT(bool(member));
+  CPPUNIT_ASSERT_EQUAL(1024ul, getRemainingLength(member));
+
+  QXPDocument::Type type = QXPDocument::TYPE_UNKNOWN;
+  CPPUNIT_ASSERT(QXPDocument::isSupported(&stream, &type));
+  CPPUNIT_ASSERT_EQUAL(QXPDocument::TYPE_DOCUMENT, type);
+}
+
+void QXPFileStreamTest::testReadAhead()
+{
+  for (const auto name : MULTI_PAGE_DOCUMENTS)
+  {
+    librevenge::RVNGFileStream input(path(name).c_str());
+    QXPTracingPainter expected;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::parse(&input, &expected));
+
+    // pages are parsed in order, there is no quick pass to find the chains
+    RecordingFileStream inOrder(path(name).c_str());
+    QXPTracingPainter inOrderPainter;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::parse(&inOrder, &inOrderPainter));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expected.trace, inOrderPainter.trace);
+    CPPUNIT_ASSERT_MESSAGE(name, inOrder.ranges.empty());
+
+    RecordingFileStream concurrent(path(name).c_str());
+    QXPParseOptions options;
+    options.setMaxThreads(2);
+    QXPTracingPainter painter;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::parse(&concurrent, &painter, nullptr, nullptr, &options));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expected.trace, painter.trace);
+
+    // sorted ranges of whole blocks, inside the file
+    const unsigned long size = readAll(concurrent).size();
+    CPPUNIT_ASSERT_MESSAGE(name, !concurrent.ranges.empty());
+    unsigned long end = 0;
+    for (const auto &range : concurrent.ranges)
+    {
+      CPPUNIT_ASSERT_MESSAGE(name, end == 0 || range.first > end);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0ul, range.first % 256);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0ul, range.second % 256);
+      end = range.first + range.second;
+      CPPUNIT_ASSERT_MESSAGE(name, end <= size + 256);
+    }
+  }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPFileStreamTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,201 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/QXPDocument.h>
+
+#include "libqxp_utils.h"
+#include "QXPDrawingRecorder.h"
+#include "QXPMacFileParser.h"
+#include "QXPSubStream.h"
+
+#if !defined TEST_DATA_DIR
+#error TEST_DATA_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libqxp::QXPDocument;
+using libqxp::QXPDrawingRecorder;
+using libqxp::QXPMacFileParser;
+using libqxp::QXPSubStream;
+using libqxp::getRemainingLength;
+using libqxp::readNBytes;
+
+using librevenge::RVNGInputStream;
+using std::string;
+using std::shared_ptr;
+using std::vector;
+
+namespace
+{
+
+/* BinHex 4.0 encodings of qxp33mac_text, with a resource fork that has
+ * runs of 0x90. The number in the name is the offset of the closing ':'
+ * in its group of 4 characters; 1 is never produced by an encoder, so
+ * that file has an extra character at the end. Lines are 64 characters
+ * long, so most line breaks are inside a group.
+ */
+const char *const BINHEX_DOCUMENTS[] =
+{
+  "qxp33mac_binhex0.hqx",
+  "qxp33mac_binhex1.hqx",
+  "qxp33mac_binhex2.hqx",
+  "qxp33mac_binhex3.hqx",
+};
+
+/* AppleSingle encoding of qxp33mac_text: a header with 2 entries, finder
+ * info at offset 50 and the data fork at offset 82.
+ */
+const char *const APPLESINGLE_DOCUMENT = "qxp33mac_applesingle";
+const unsigned long APPLESINGLE_DATA_ENTRY = 38;
+
+string path(const string &name)
+{
+  return string(TEST_DATA_DIR) + "/" + name;
+}
+
+shared_ptr<RVNGInputStream> openFile(const string &name)
+{
+  return shared_ptr<RVNGInputStream>(new librevenge::RVNGFileStream(path(name).c_str()));
+}
+
+vector<unsigned char> readAll(const shared_ptr<RVNGInputStream> &stream)
+{
+  stream->seek(0, librevenge::RVNG_SEEK_SET);
+  const unsigned long length = getRemainingLength(stream);
+  const unsigned char *const data = readNBytes(stream, length);
+  return vector<unsigned char>(data, data + length);
+}
+
+}
+
+class QXPMacFileParserTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPMacFileParserTest);
+  CPPUNIT_TEST(testBinHex);
+  CPPUNIT_TEST(testMacMIME);
+  CPPUNIT_TEST(testMacMIMEEntryPastEnd);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testBinHex();
+  void testMacMIME();
+  void testMacMIMEEntryPastEnd();
+};
+
+void QXPMacFileParserTest::setUp()
+{
+}
+
+void QXPMacFileParserTest::tearDown()
+{
+}
+
+void QXPMacFileParserTest::testBinHex()
+{
+  const vector<unsigned char> expected = readAll(openFile("qxp33mac_text"));
+
+  for (const auto name : BINHEX_DOCUMENTS)
+  {
+    shared_ptr<RVNGInputStream> dataFork;
+    string type;
+    string creator;
+    QXPMacFileParser parser(dataFork, type, creator);
+    CPPUNIT_ASSERT_MESSAGE(name, parser.parse(openFile(name)));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::WRAPPER_BINHEX, parser.wrapper());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, string("XDOC"), type);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, string("XPR3"), creator);
+    CPPUNIT_ASSERT_MESSAGE(name, bool(dataFork));
+    CPPUNIT_ASSERT_MESSAGE(name, expected == readAll(dataFork));
+
+    librevenge::RVNGFileStream input(path(name).c_str());
+    QXPDocument::Type docType = QXPDocument::TYPE_UNKNOWN;
+    CPPUNIT_ASSERT_MESSAGE(name, QXPDocument::isSupported(&input, &docType));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::TYPE_DOCUMENT, docType);
+    QXPDrawingRecorder painter;
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, QXPDocument::RESULT_OK, QXPDocument::parse(&input, &painter));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 1u, painter.completePages());
+  }
+}
+
+void QXPMacFileParserTest::testMacMIME()
+{
+  const vector<unsigned char> expected = readAll(openFile("qxp33mac_text"));
+
+  // AppleDouble files are parsed the same way, if they have a data fork
+  vector<unsigned char> appleDouble = readAll(openFile(APPLESINGLE_DOCUMENT));
+  appleDouble[3] = 0x07;
+
+  const shared_ptr<RVNGInputStream> inputs[] =
+  {
+    openFile(APPLESINGLE_DOCUMENT),
+    shared_ptr<RVNGInputStream>(new librevenge::RVNGStringStream(appleDouble.data(), unsigned(appleDouble.size())))
+  };
+  for (const auto &input : inputs)
+  {
+    shared_ptr<RVNGInputStream> dataFork;
+    string type;
+    string creator;
+    QXPMacFileParser parser(dataFork, type, creator);
+    CPPUNIT_ASSERT(parser.parse(input));
+    CPPUNIT_ASSERT_EQUAL(QXPDocument::WRAPPER_MACMIME, parser.wrapper());
+    CPPUNIT_ASSERT_EQUAL(string("XDOC"), type);
+    CPPUNIT_ASSERT_EQUAL(string("XPR3"), creator);
+    // the data fork is not copied
+    CPPUNIT_ASSERT(bool(std::dynamic_pointer_cast<QXPSubStream>(dataFork)));
+    CPPUNIT_ASSERT(expected == readAll(dataFork));
+  }
+
+  librevenge::RVNGFileStream input(path(APPLESINGLE_DOCUMENT).c_str());
+  QXPDocument::Type type = QXPDocument::TYPE_UNKNOWN;
+  CPPUNIT_ASSERT(QXPDocument::isSupported(&input, &type));
+  CPPUNIT_ASSERT_EQUAL(QXPDocument::TYPE_DOCUMENT, type);
+  QXPDrawingRecorder painter;
+  CPPUNIT_ASSERT_EQUAL(QXPDocument::RESULT_OK, QXPDocument::parse(&input, &painter));
+  CPPUNIT_ASSERT_EQUAL(1u, painter.completePages());
+}
+
+void QXPMacFileParserTest::testMacMIMEEntryPastEnd()
+{
+  vector<unsigned char> data = readAll(openFile(APPLESINGLE_DOCUMENT));
+  // make the data fork one byte longer than what is left of the file
+  unsigned char *const length = &data[APPLESINGLE_DATA_ENTRY + 8];
+  CPPUNIT_ASSERT_EQUAL(0x14u, unsigned(length[2]));
+  length[3] = 0x01;
+
+  shared_ptr<RVNGInputStream> dataFork;
+  string type;
+  string creator;
+  QXPMacFileParser parser(dataFork, type, creator);
+  CPPUNIT_ASSERT(!parser.parse(shared_ptr<RVNGInputStream>(new librevenge::RVNGStringStream(data.data(), unsigned(data.size())))));
+  CPPUNIT_ASSERT(!std::dynamic_pointer_cast<QXPSubStream>(dataFork));
+
+  librevenge::RVNGStringStream input(data.data(), unsigned(data.size()));
+  CPPUNIT_ASSERT(!QXPDocument::isSupported(&input));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPMacFileParserTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
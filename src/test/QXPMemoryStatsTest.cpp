@@ -0,0 +1,86 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <libqxp/QXPMemoryStats.h>
+
+namespace test
+{
+
+using libqxp::QXPMemoryStats;
+
+class QXPMemoryStatsTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPMemoryStatsTest);
+  CPPUNIT_TEST(testPeak);
+  CPPUNIT_TEST(testTotalPeak);
+  CPPUNIT_TEST(testOverRelease);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testPeak();
+  void testTotalPeak();
+  void testOverRelease();
+};
+
+void QXPMemoryStatsTest::setUp()
+{
+}
+
+void QXPMemoryStatsTest::tearDown()
+{
+}
+
+void QXPMemoryStatsTest::testPeak()
+{
+  QXPMemoryStats stats;
+  stats.allocate(QXPMemoryStats::CATEGORY_PICTURES, 100);
+  stats.allocate(QXPMemoryStats::CATEGORY_PICTURES, 50);
+  stats.release(QXPMemoryStats::CATEGORY_PICTURES, 100);
+  CPPUNIT_ASSERT_EQUAL(50ul, stats.usage(QXPMemoryStats::CATEGORY_PICTURES).current);
+  CPPUNIT_ASSERT_EQUAL(150ul, stats.usage(QXPMemoryStats::CATEGORY_PICTURES).peak);
+  CPPUNIT_ASSERT_EQUAL(0ul, stats.usage(QXPMemoryStats::CATEGORY_TEXTS).peak);
+
+  stats.clear();
+  CPPUNIT_ASSERT_EQUAL(0ul, stats.usage(QXPMemoryStats::CATEGORY_PICTURES).current);
+  CPPUNIT_ASSERT_EQUAL(0ul, stats.usage(QXPMemoryStats::CATEGORY_PICTURES).peak);
+}
+
+void QXPMemoryStatsTest::testTotalPeak()
+{
+  QXPMemoryStats stats;
+  stats.allocate(QXPMemoryStats::CATEGORY_STREAMS, 100);
+  stats.release(QXPMemoryStats::CATEGORY_STREAMS, 100);
+  stats.allocate(QXPMemoryStats::CATEGORY_TEXTS, 80);
+  CPPUNIT_ASSERT_EQUAL(80ul, stats.total().current);
+  CPPUNIT_ASSERT_EQUAL(100ul, stats.total().peak);
+}
+
+void QXPMemoryStatsTest::testOverRelease()
+{
+  QXPMemoryStats stats;
+  stats.allocate(QXPMemoryStats::CATEGORY_PAGES, 10);
+  stats.allocate(QXPMemoryStats::CATEGORY_TEXTS, 10);
+  stats.release(QXPMemoryStats::CATEGORY_PAGES, 20);
+  CPPUNIT_ASSERT_EQUAL(0ul, stats.usage(QXPMemoryStats::CATEGORY_PAGES).current);
+  CPPUNIT_ASSERT_EQUAL(10ul, stats.total().current);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPMemoryStatsTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
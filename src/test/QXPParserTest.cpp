@@ -0,0 +1,393 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <memory>
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <libqxp/QXPMemoryStats.h>
+#include <libqxp/QXPParseOptions.h>
+
+#include "libqxp_utils.h"
+#include "QXPCollector.h"
+#include "QXPDetector.h"
+#include "QXPHeader.h"
+#include "QXPParser.h"
+#include "QXPTypes.h"
+
+#include "QXPTracingPainter.h"
+
+#if !defined TEST_DATA_DIR
+#error TEST_DATA_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libqxp::Box;
+using libqxp::Group;
+using libqxp::Line;
+using libqxp::Page;
+using libqxp::PictureBox;
+using libqxp::QXPCollector;
+using libqxp::QXPDetector;
+using libqxp::QXPMemoryStats;
+using libqxp::QXPParseOptions;
+using libqxp::Text;
+using libqxp::TextBox;
+using libqxp::TextPath;
+
+using std::shared_ptr;
+using std::string;
+
+namespace
+{
+
+const char *const DOCUMENTS[] =
+{
+  "qxp1.zip",
+  "qxp31mac",
+  "qxp31win.qxd",
+  "qxp33mac",
+  "qxp33mac_text",
+  "qxp33win.qxd",
+  "qxp33win_text.qxd",
+  "qxp4mac",
+  "qxp4mac_text",
+  "qxp4win.qxd",
+  "qxp4win_text.qxd",
+};
+
+// copies of the _text documents with the master pages turned into normal pages
+const char *const MULTI_PAGE_DOCUMENTS[] =
+{
+  "qxp33mac_pages",
+  "qxp4win_pages.qxd",
+};
+
+class CountingCollector : public QXPCollector
+{
+public:
+  explicit CountingCollector(const bool pagesNeeded)
+    : pages(0)
+    , objects(0)
+    , texts(0)
+    , characters(0)
+    , m_pagesNeeded(pagesNeeded)
+  {
+  }
+
+  bool isPageNeeded(unsigned) const override
+  {
+    return m_pagesNeeded;
+  }
+
+  void startPage(const Page &) override
+  {
+    ++pages;
+  }
+
+  void collectLine(const shared_ptr<Line> &) override
+  {
+    ++objects;
+  }
+
+  void collectBox(const shared_ptr<Box> &) override
+  {
+    ++objects;
+  }
+
+  void collectPictureBox(const shared_ptr<PictureBox> &) override
+  {
+    ++objects;
+  }
+
+  void collectTextBox(const shared_ptr<TextBox> &) override
+  {
+    ++objects;
+  }
+
+  void collectTextPath(const shared_ptr<TextPath> &) override
+  {
+    ++objects;
+  }
+
+  void collectGroup(const shared_ptr<Group> &) override
+  {
+    ++objects;
+  }
+
+  void collectText(const shared_ptr<Text> &text, const unsigned) override
+  {
+    ++texts;
+    characters += text->text.size();
+  }
+
+  unsigned pages;
+  unsigned objects;
+  unsigned texts;
+  size_t characters;
+
+private:
+  const bool m_pagesNeeded;
+};
+
+class ProgressOptions : public QXPParseOptions
+{
+public:
+  ProgressOptions()
+    : calls(0)
+    , done(0)
+    , total(0)
+    , m_ordered(true)
+  {
+  }
+
+  void progress(const unsigned done_, const unsigned total_) override
+  {
+    ++calls;
+    if (done_ != done + 1)
+      m_ordered = false;
+    done = done_;
+    total = total_;
+  }
+
+  bool isOrdered() const
+  {
+    return m_ordered;
+  }
+
+  unsigned calls;
+  unsigned done;
+  unsigned total;
+
+private:
+  bool m_ordered;
+};
+
+void parse(const string &name, CountingCollector &collector, const unsigned maxThreads = 1, QXPParseOptions *const options = nullptr, const unsigned minBackgroundContent = 16)
+{
+  QXPDetector detector;
+  detector.detect(shared_ptr<librevenge::RVNGInputStream>(new librevenge::RVNGFileStream((string(TEST_DATA_DIR) + "/" + name).c_str())));
+  CPPUNIT_ASSERT_MESSAGE(name, detector.isSupported());
+  const auto parser = detector.header()->createParser(detector.input(), nullptr);
+  parser->setMaxThreads(maxThreads);
+  parser->setMinBackgroundContent(minBackgroundContent);
+  parser->setParseOptions(options);
+  CPPUNIT_ASSERT_MESSAGE(name, parser->parse(collector));
+}
+
+class CancellingOptions : public QXPParseOptions
+{
+public:
+  explicit CancellingOptions(const unsigned pages)
+    : m_pages(pages)
+  {
+  }
+
+  void progress(const unsigned done, unsigned) override
+  {
+    if (done == m_pages)
+      cancel();
+  }
+
+private:
+  const unsigned m_pages;
+};
+
+void draw(const string &name, QXPTracingPainter &painter, const unsigned maxThreads, QXPParseOptions *const options = nullptr, QXPMemoryStats *const stats = nullptr)
+{
+  QXPDetector detector;
+  detector.detect(shared_ptr<librevenge::RVNGInputStream>(new librevenge::RVNGFileStream((string(TEST_DATA_DIR) + "/" + name).c_str())));
+  CPPUNIT_ASSERT_MESSAGE(name, detector.isSupported());
+  const auto parser = detector.header()->createParser(detector.input(), &painter);
+  parser->setMaxThreads(maxThreads);
+  parser->setMemoryStats(stats);
+  parser->setParseOptions(options);
+  CPPUNIT_ASSERT_MESSAGE(name, parser->parse());
+}
+
+}
+
+class QXPParserTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPParserTest);
+  CPPUNIT_TEST(testSkipPages);
+  CPPUNIT_TEST(testConcurrentPages);
+  CPPUNIT_TEST(testBackgroundStories);
+  CPPUNIT_TEST(testProgress);
+  CPPUNIT_TEST(testCancel);
+  CPPUNIT_TEST(testCancelFromProgress);
+  CPPUNIT_TEST(testDeadline);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testSkipPages();
+  void testConcurrentPages();
+  void testBackgroundStories();
+  void testProgress();
+  void testCancel();
+  void testCancelFromProgress();
+  void testDeadline();
+};
+
+void QXPParserTest::setUp()
+{
+}
+
+void QXPParserTest::tearDown()
+{
+}
+
+void QXPParserTest::testSkipPages()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    CountingCollector all(true);
+    parse(name, all);
+    CPPUNIT_ASSERT_MESSAGE(name, all.pages > 0);
+
+    CountingCollector none(false);
+    parse(name, none);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, none.pages);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, none.objects);
+    // stories are still read, as their other boxes might be on needed pages
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, all.texts, none.texts);
+  }
+}
+
+void QXPParserTest::testConcurrentPages()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    CountingCollector sequential(true);
+    parse(name, sequential);
+
+    // 1.x documents are always parsed in order
+    CountingCollector concurrent(true);
+    parse(name, concurrent, 4);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, sequential.pages, concurrent.pages);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, sequential.objects, concurrent.objects);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, sequential.texts, concurrent.texts);
+  }
+
+  for (const auto name : MULTI_PAGE_DOCUMENTS)
+  {
+    QXPTracingPainter sequential;
+    QXPMemoryStats sequentialStats;
+    draw(name, sequential, 1, nullptr, &sequentialStats);
+    CPPUNIT_ASSERT_MESSAGE(name, sequential.pages > 1);
+
+    for (const unsigned threads : {2u, 4u})
+    {
+      QXPTracingPainter concurrent;
+      QXPMemoryStats concurrentStats;
+      draw(name, concurrent, threads, nullptr, &concurrentStats);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, sequential.trace, concurrent.trace);
+      // the workers share the pages instead of each reading its own copy
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, sequentialStats.usage(QXPMemoryStats::CATEGORY_STREAMS).peak, concurrentStats.usage(QXPMemoryStats::CATEGORY_STREAMS).peak);
+    }
+  }
+}
+
+void QXPParserTest::testBackgroundStories()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    CountingCollector inOrder(true);
+    parse(name, inOrder);
+
+    // the test documents are too small to parse pages concurrently, so only stories go to the background;
+    // they have too few stories for that too, unless all of them are sent there
+    for (const unsigned minBackgroundContent : {0u, 16u})
+    {
+      CountingCollector background(true);
+      parse(name, background, 0, nullptr, minBackgroundContent);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, inOrder.pages, background.pages);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, inOrder.objects, background.objects);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, inOrder.texts, background.texts);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, inOrder.characters, background.characters);
+    }
+  }
+}
+
+void QXPParserTest::testProgress()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    for (const unsigned threads : {1u, 4u})
+    {
+      ProgressOptions options;
+      CountingCollector collector(true);
+      parse(name, collector, threads, &options);
+      CPPUNIT_ASSERT_MESSAGE(name, options.isOrdered());
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, options.total, options.calls);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name, options.total, options.done);
+      CPPUNIT_ASSERT_MESSAGE(name, options.total > 0);
+    }
+  }
+}
+
+void QXPParserTest::testCancel()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    ProgressOptions options;
+    options.cancel();
+    CountingCollector collector(true);
+    CPPUNIT_ASSERT_THROW(parse(name, collector, 1, &options), libqxp::ParseCancelled);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, collector.pages);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, options.calls);
+  }
+}
+
+void QXPParserTest::testCancelFromProgress()
+{
+  for (const auto name : MULTI_PAGE_DOCUMENTS)
+  {
+    QXPTracingPainter all;
+    draw(name, all, 1);
+
+    for (const unsigned threads : {1u, 2u})
+    {
+      CancellingOptions options(1);
+      QXPTracingPainter painter;
+      CPPUNIT_ASSERT_THROW(draw(name, painter, threads, &options), libqxp::ParseCancelled);
+      CPPUNIT_ASSERT_MESSAGE(name, painter.pages < all.pages);
+      // nothing is drawn after the parse stopped, not even by the collector's destructor
+      CPPUNIT_ASSERT_MESSAGE(name, painter.trace.find("endDocument") == string::npos);
+    }
+  }
+}
+
+void QXPParserTest::testDeadline()
+{
+  for (const auto name : DOCUMENTS)
+  {
+    ProgressOptions options;
+    options.setDeadline(QXPParseOptions::Clock::now());
+    CountingCollector collector(true);
+    CPPUNIT_ASSERT_THROW(parse(name, collector, 4, &options), libqxp::DeadlineExceeded);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, collector.pages);
+  }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPParserTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
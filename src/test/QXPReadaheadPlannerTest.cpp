@@ -0,0 +1,99 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "QXPReadaheadPlanner.h"
+
+namespace test
+{
+
+using libqxp::QXPReadaheadPlanner;
+
+using std::vector;
+
+class QXPReadaheadPlannerTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPReadaheadPlannerTest);
+  CPPUNIT_TEST(testMerge);
+  CPPUNIT_TEST(testNeeds);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testMerge();
+  void testNeeds();
+};
+
+void QXPReadaheadPlannerTest::setUp()
+{
+}
+
+void QXPReadaheadPlannerTest::tearDown()
+{
+}
+
+void QXPReadaheadPlannerTest::testMerge()
+{
+  QXPReadaheadPlanner planner(256, 100, true, true);
+  CPPUNIT_ASSERT(planner.empty());
+
+  planner.addText(40);
+  planner.addPicture(3);
+  planner.addText(4);
+  planner.addText(3); // the same chain again
+  planner.addPicture(6);
+  planner.addText(0); // no chain
+  planner.addPicture(101); // past the end
+  CPPUNIT_ASSERT(!planner.empty());
+
+  // adjacent blocks only
+  const vector<QXPReadaheadPlanner::Range> adjacent = planner.plan(0);
+  CPPUNIT_ASSERT_EQUAL(size_t(3), adjacent.size());
+  CPPUNIT_ASSERT_EQUAL(512ul, adjacent[0].first);
+  CPPUNIT_ASSERT_EQUAL(512ul, adjacent[0].second);
+  CPPUNIT_ASSERT_EQUAL(1280ul, adjacent[1].first);
+  CPPUNIT_ASSERT_EQUAL(256ul, adjacent[1].second);
+  CPPUNIT_ASSERT_EQUAL(9984ul, adjacent[2].first);
+  CPPUNIT_ASSERT_EQUAL(256ul, adjacent[2].second);
+
+  // the gap of one block is read too
+  const vector<QXPReadaheadPlanner::Range> close = planner.plan(256);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), close.size());
+  CPPUNIT_ASSERT_EQUAL(512ul, close[0].first);
+  CPPUNIT_ASSERT_EQUAL(1024ul, close[0].second);
+  CPPUNIT_ASSERT_EQUAL(9984ul, close[1].first);
+}
+
+void QXPReadaheadPlannerTest::testNeeds()
+{
+  QXPReadaheadPlanner texts(256, 100, true, false);
+  texts.addPicture(5);
+  CPPUNIT_ASSERT(texts.empty());
+  texts.addText(5);
+  CPPUNIT_ASSERT(!texts.empty());
+
+  QXPReadaheadPlanner pictures(256, 100, false, true);
+  pictures.addText(5);
+  CPPUNIT_ASSERT(pictures.empty());
+  pictures.addPicture(5);
+  CPPUNIT_ASSERT(!pictures.empty());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPReadaheadPlannerTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
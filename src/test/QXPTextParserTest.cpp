@@ -35,13 +35,13 @@ using libqxp::QXPDetector;
 using libqxp::QXPTextParser;
 using libqxp::CharFormat;
 using libqxp::ParagraphFormat;
+using libqxp::TextFormats;
 
 using librevenge::RVNGInputStream;
 using std::string;
 using std::map;
 using std::make_shared;
 using std::shared_ptr;
-using std::vector;
 
 namespace
 {
@@ -98,20 +98,20 @@ void QXPTextParserTest::testParseText()
     const auto name = item.first;
     const auto index = item.second;
 
-    vector<shared_ptr<CharFormat>> charFormats;
-    charFormats.push_back(make_shared<CharFormat>(CharFormat()));
-    vector<shared_ptr<ParagraphFormat>> paragraphFormats;
-    paragraphFormats.push_back(make_shared<ParagraphFormat>(ParagraphFormat()));
+    auto formats = make_shared<TextFormats>();
+    formats->charFormats.push_back(CharFormat());
+    formats->paragraphFormats.push_back(ParagraphFormat());
 
     auto parser = createParser(name);
-    auto text = parser->parseText(index, charFormats, paragraphFormats);
+    auto text = parser->parseText(index, formats);
     CPPUNIT_ASSERT_EQUAL_MESSAGE(name, expectedText, text->text);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 258u, text->charFormats[0].length);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, text->charFormats[0].startIndex);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, charFormats[0].get(), text->charFormats[0].format.get());
-    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 258u, text->paragraphs[0].length);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, text->paragraphs[0].startIndex);
-    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, paragraphFormats[0].get(), text->paragraphs[0].format.get());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 258u, text->charFormats.length(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, text->charFormats.startIndex(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, text->charFormats.formatIndexes[0]);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, &formats->charFormats[0], &text->charFormat(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 258u, text->paragraphs.length(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, 0u, text->paragraphs.startIndex(0));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name, &formats->paragraphFormats[0], &text->paragraphFormat(0));
   }
 }
 
@@ -0,0 +1,301 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef QXPTRACINGPAINTER_H_INCLUDED
+#define QXPTRACINGPAINTER_H_INCLUDED
+
+#include <string>
+
+#include <librevenge/librevenge.h>
+
+namespace test
+{
+
+/** Writes every call to a string, so the output of two parses can be compared.
+  */
+class QXPTracingPainter : public librevenge::RVNGDrawingInterface
+{
+public:
+  QXPTracingPainter()
+    : trace()
+    , pages(0)
+  {
+  }
+
+  void startDocument(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("startDocument", propList);
+  }
+
+  void endDocument() override
+  {
+    add("endDocument");
+  }
+
+  void setDocumentMetaData(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("setDocumentMetaData", propList);
+  }
+
+  void defineEmbeddedFont(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("defineEmbeddedFont", propList);
+  }
+
+  void startPage(const librevenge::RVNGPropertyList &propList) override
+  {
+    ++pages;
+    add("startPage", propList);
+  }
+
+  void endPage() override
+  {
+    add("endPage");
+  }
+
+  void startMasterPage(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("startMasterPage", propList);
+  }
+
+  void endMasterPage() override
+  {
+    add("endMasterPage");
+  }
+
+  void startLayer(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("startLayer", propList);
+  }
+
+  void endLayer() override
+  {
+    add("endLayer");
+  }
+
+  void startEmbeddedGraphics(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("startEmbeddedGraphics", propList);
+  }
+
+  void endEmbeddedGraphics() override
+  {
+    add("endEmbeddedGraphics");
+  }
+
+  void openGroup(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openGroup", propList);
+  }
+
+  void closeGroup() override
+  {
+    add("closeGroup");
+  }
+
+  void setStyle(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("setStyle", propList);
+  }
+
+  void drawRectangle(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawRectangle", propList);
+  }
+
+  void drawEllipse(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawEllipse", propList);
+  }
+
+  void drawPolygon(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawPolygon", propList);
+  }
+
+  void drawPolyline(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawPolyline", propList);
+  }
+
+  void drawPath(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawPath", propList);
+  }
+
+  void drawGraphicObject(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawGraphicObject", propList);
+  }
+
+  void drawConnector(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("drawConnector", propList);
+  }
+
+  void startTextObject(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("startTextObject", propList);
+  }
+
+  void endTextObject() override
+  {
+    add("endTextObject");
+  }
+
+  void startTableObject(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("startTableObject", propList);
+  }
+
+  void openTableRow(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openTableRow", propList);
+  }
+
+  void closeTableRow() override
+  {
+    add("closeTableRow");
+  }
+
+  void openTableCell(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openTableCell", propList);
+  }
+
+  void closeTableCell() override
+  {
+    add("closeTableCell");
+  }
+
+  void insertCoveredTableCell(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("insertCoveredTableCell", propList);
+  }
+
+  void endTableObject() override
+  {
+    add("endTableObject");
+  }
+
+  void openOrderedListLevel(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openOrderedListLevel", propList);
+  }
+
+  void closeOrderedListLevel() override
+  {
+    add("closeOrderedListLevel");
+  }
+
+  void openUnorderedListLevel(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openUnorderedListLevel", propList);
+  }
+
+  void closeUnorderedListLevel() override
+  {
+    add("closeUnorderedListLevel");
+  }
+
+  void openListElement(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openListElement", propList);
+  }
+
+  void closeListElement() override
+  {
+    add("closeListElement");
+  }
+
+  void defineParagraphStyle(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("defineParagraphStyle", propList);
+  }
+
+  void openParagraph(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openParagraph", propList);
+  }
+
+  void closeParagraph() override
+  {
+    add("closeParagraph");
+  }
+
+  void defineCharacterStyle(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("defineCharacterStyle", propList);
+  }
+
+  void openSpan(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openSpan", propList);
+  }
+
+  void closeSpan() override
+  {
+    add("closeSpan");
+  }
+
+  void openLink(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("openLink", propList);
+  }
+
+  void closeLink() override
+  {
+    add("closeLink");
+  }
+
+  void insertTab() override
+  {
+    add("insertTab");
+  }
+
+  void insertSpace() override
+  {
+    add("insertSpace");
+  }
+
+  void insertText(const librevenge::RVNGString &text) override
+  {
+    add("insertText", text.cstr());
+  }
+
+  void insertLineBreak() override
+  {
+    add("insertLineBreak");
+  }
+
+  void insertField(const librevenge::RVNGPropertyList &propList) override
+  {
+    add("insertField", propList);
+  }
+
+  std::string trace;
+  unsigned pages;
+
+private:
+  void add(const char *const call, const librevenge::RVNGPropertyList &propList)
+  {
+    add(call, propList.getPropString().cstr());
+  }
+
+  void add(const char *const call, const char *const args = "")
+  {
+    trace.append(call).append("(").append(args).append(")\n");
+  }
+};
+
+}
+
+#endif // QXPTRACINGPAINTER_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,6 +10,7 @@
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <memory>
 #include <string>
 
 #include "QXPTypes.h"
@@ -17,8 +18,13 @@
 namespace test
 {
 
+using libqxp::CharFormat;
 using libqxp::Color;
+using libqxp::ParagraphFormat;
+using libqxp::Text;
+using libqxp::TextFormats;
 
+using std::make_shared;
 using std::string;
 
 class QXPTypesTest : public CPPUNIT_NS::TestFixture
@@ -30,10 +36,12 @@ public:
 private:
   CPPUNIT_TEST_SUITE(QXPTypesTest);
   CPPUNIT_TEST(testColorShade);
+  CPPUNIT_TEST(testTextMetrics);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testColorShade();
+  void testTextMetrics();
 };
 
 void QXPTypesTest::setUp()
@@ -53,6 +61,51 @@ void QXPTypesTest::testColorShade()
   CPPUNIT_ASSERT_EQUAL(string(Color(1, 160, 198).toString().cstr()), string(Color(1, 160, 198).applyShade(-99.8).toString().cstr()));
 }
 
+void QXPTypesTest::testTextMetrics()
+{
+  auto formats = make_shared<TextFormats>();
+  formats->charFormats.resize(3);
+  formats->charFormats[0].fontSize = 8;
+  formats->charFormats[1].fontSize = 24;
+  formats->charFormats[2].fontSize = 72;
+  formats->charFormats[2].isControlChars = true;
+  formats->paragraphFormats.resize(1);
+
+  Text text;
+  text.text = string(30, 'x');
+  text.formats = formats;
+  text.charFormats.append(0, 5);
+  text.charFormats.append(1, 10);
+  text.charFormats.append(2, 1);
+  text.charFormats.append(0, 14);
+  text.paragraphs.append(0, 5);
+  text.paragraphs.append(0, 8);
+  text.paragraphs.append(0, 17);
+  text.updateMetrics();
+
+  CPPUNIT_ASSERT_EQUAL(16u, text.charFormats.startIndex(3));
+  CPPUNIT_ASSERT_EQUAL(30u, text.charFormats.afterEndIndex());
+  CPPUNIT_ASSERT_EQUAL(&formats->charFormats[1], &text.charFormat(1));
+
+  CPPUNIT_ASSERT_EQUAL(size_t(3), text.paragraphMetrics.size());
+  CPPUNIT_ASSERT_EQUAL(24.0, text.maxFontSize());
+
+  CPPUNIT_ASSERT_EQUAL(8.0, text.maxFontSize(0));
+  CPPUNIT_ASSERT_EQUAL(0u, text.paragraphMetrics[0].firstCharFormat);
+  CPPUNIT_ASSERT_EQUAL(1u, text.paragraphMetrics[0].charFormatsCount);
+
+  CPPUNIT_ASSERT_EQUAL(24.0, text.maxFontSize(1));
+  CPPUNIT_ASSERT_EQUAL(1u, text.paragraphMetrics[1].firstCharFormat);
+  CPPUNIT_ASSERT_EQUAL(1u, text.paragraphMetrics[1].charFormatsCount);
+
+  // control chars do not count
+  CPPUNIT_ASSERT_EQUAL(24.0, text.maxFontSize(2));
+  CPPUNIT_ASSERT_EQUAL(1u, text.paragraphMetrics[2].firstCharFormat);
+  CPPUNIT_ASSERT_EQUAL(3u, text.paragraphMetrics[2].charFormatsCount);
+
+  CPPUNIT_ASSERT_EQUAL(0.0, text.maxFontSize(3));
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(QXPTypesTest);
 
 }
@@ -0,0 +1,103 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <atomic>
+#include <future>
+#include <stdexcept>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "QXPWorkerPool.h"
+
+namespace test
+{
+
+using libqxp::QXPWorkerPool;
+
+using std::future;
+using std::vector;
+
+class QXPWorkerPoolTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPWorkerPoolTest);
+  CPPUNIT_TEST(testResults);
+  CPPUNIT_TEST(testException);
+  CPPUNIT_TEST(testDestroyRunsQueued);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testResults();
+  void testException();
+  void testDestroyRunsQueued();
+};
+
+void QXPWorkerPoolTest::setUp()
+{
+}
+
+void QXPWorkerPoolTest::tearDown()
+{
+}
+
+void QXPWorkerPoolTest::testResults()
+{
+  QXPWorkerPool pool(3);
+  vector<future<unsigned>> results;
+  for (unsigned i = 0; i != 100; ++i)
+    results.push_back(pool.submit([i]()
+  {
+    return i * i;
+  }));
+  for (unsigned i = 0; i != 100; ++i)
+    CPPUNIT_ASSERT_EQUAL(i * i, results[i].get());
+}
+
+void QXPWorkerPoolTest::testException()
+{
+  QXPWorkerPool pool(2);
+  auto failed = pool.submit([]() -> int
+  {
+    throw std::runtime_error("failed");
+  });
+  auto succeeded = pool.submit([]()
+  {
+    return 1;
+  });
+  CPPUNIT_ASSERT_THROW(failed.get(), std::runtime_error);
+  CPPUNIT_ASSERT_EQUAL(1, succeeded.get());
+}
+
+void QXPWorkerPoolTest::testDestroyRunsQueued()
+{
+  std::atomic<unsigned> count(0);
+  vector<future<void>> results;
+  {
+    QXPWorkerPool pool(1);
+    for (unsigned i = 0; i != 50; ++i)
+      results.push_back(pool.submit([&count]()
+    {
+      ++count;
+    }));
+  }
+  CPPUNIT_ASSERT_EQUAL(50u, count.load());
+  for (auto &result : results)
+    result.get();
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPWorkerPoolTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,136 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libqxp project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include <string>
+#include <memory>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include <zlib.h>
+
+#include "libqxp_utils.h"
+#include "QXPZipStream.h"
+
+#if !defined TEST_DATA_DIR
+#error TEST_DATA_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libqxp::QXPZipStream;
+using libqxp::getRemainingLength;
+using libqxp::readNBytes;
+using libqxp::readU16;
+using libqxp::seek;
+
+using librevenge::RVNGInputStream;
+using std::string;
+using std::shared_ptr;
+using std::vector;
+
+namespace
+{
+
+shared_ptr<RVNGInputStream> openFile(const string &name)
+{
+  return shared_ptr<RVNGInputStream>(new librevenge::RVNGFileStream((string(TEST_DATA_DIR) + "/" + name).c_str()));
+}
+
+vector<unsigned char> readAll(const shared_ptr<RVNGInputStream> &stream)
+{
+  stream->seek(0, librevenge::RVNG_SEEK_SET);
+  const unsigned long length = getRemainingLength(stream);
+  const unsigned char *const data = readNBytes(stream, length);
+  return vector<unsigned char>(data, data + length);
+}
+
+}
+
+class QXPZipStreamTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp() override;
+  virtual void tearDown() override;
+
+private:
+  CPPUNIT_TEST_SUITE(QXPZipStreamTest);
+  CPPUNIT_TEST(testOpen);
+  CPPUNIT_TEST(testRandomAccess);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testOpen();
+  void testRandomAccess();
+};
+
+void QXPZipStreamTest::setUp()
+{
+}
+
+void QXPZipStreamTest::tearDown()
+{
+}
+
+void QXPZipStreamTest::testOpen()
+{
+  const auto archive = openFile("qxp1.zip");
+
+  const auto member = QXPZipStream::open(archive, "qxp1");
+  CPPUNIT_ASSERT(bool(member));
+  const auto content = readAll(member);
+  CPPUNIT_ASSERT_EQUAL(size_t(1024), content.size());
+  CPPUNIT_ASSERT_EQUAL(0x830bbec8ul, crc32(0, content.data(), uInt(content.size())));
+  CPPUNIT_ASSERT(member->isEnd());
+
+  const auto rsrc = QXPZipStream::open(archive, "__MACOSX/._qxp1");
+  CPPUNIT_ASSERT(bool(rsrc));
+  CPPUNIT_ASSERT_EQUAL(120ul, getRemainingLength(rsrc));
+
+  CPPUNIT_ASSERT(!QXPZipStream::open(archive, "qxp2"));
+  CPPUNIT_ASSERT(!QXPZipStream::open(openFile("qxp4mac"), "qxp1"));
+}
+
+void QXPZipStreamTest::testRandomAccess()
+{
+  const auto archive = openFile("qxp1.zip");
+  const auto expected = readAll(QXPZipStream::open(archive, "qxp1"));
+
+  // the first member starts the archive; its local header does not
+  // contain the sizes, as they follow the data
+  const unsigned long compressedSize = 493;
+  const unsigned long size = expected.size();
+  seek(archive, 26);
+  const unsigned nameLength = readU16(archive);
+  const unsigned extraLength = readU16(archive);
+  // tiny chunks and cache, to force decoding again from checkpoints
+  const shared_ptr<RVNGInputStream> member(new QXPZipStream(archive, 30 + nameLength + extraLength, compressedSize, size, 16, 2, 64));
+
+  const unsigned long positions[] = {1000, 0, 500, 17, 999, 64, 63, 700, 128, 5};
+  for (const auto pos : positions)
+  {
+    CPPUNIT_ASSERT_EQUAL(0, member->seek(long(pos), librevenge::RVNG_SEEK_SET));
+    const unsigned long length = std::min(40ul, size - pos);
+    unsigned long numBytesRead = 0;
+    const unsigned char *const data = member->read(length, numBytesRead);
+    CPPUNIT_ASSERT_EQUAL(length, numBytesRead);
+    CPPUNIT_ASSERT(std::equal(data, data + length, expected.begin() + long(pos)));
+  }
+
+  CPPUNIT_ASSERT(expected == readAll(member));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(QXPZipStreamTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -8,6 +8,7 @@
  */
 
 #include <memory>
+#include <string>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -15,6 +16,7 @@
 #include <librevenge-stream/librevenge-stream.h>
 
 #include "libqxp_utils.h"
+#include "QXPTracingPainter.h"
 
 namespace test
 {
@@ -24,6 +26,71 @@ using libqxp::readFraction;
 
 using librevenge::RVNGStringStream;
 using std::make_shared;
+using std::string;
+
+namespace
+{
+
+// insertText as it was before it scanned whole runs of text, one character at a time
+void insertTextByCharacter(librevenge::RVNGDrawingInterface *painter, const librevenge::RVNGString &text)
+{
+  bool wasSpace = false;
+  string curText;
+
+  const auto flushText = [&]()
+  {
+    if (!curText.empty())
+    {
+      painter->insertText(librevenge::RVNGString(curText.c_str()));
+      curText.clear();
+    }
+  };
+
+  librevenge::RVNGString::Iter iter(text);
+  iter.rewind();
+  while (iter.next())
+  {
+    const char *const utf8Char = iter();
+    switch (utf8Char[0])
+    {
+    case '\r':
+      wasSpace = false;
+      break;
+    case '\n':
+      wasSpace = false;
+      flushText();
+      painter->insertLineBreak();
+      break;
+    case '\t':
+      wasSpace = false;
+      flushText();
+      painter->insertTab();
+      break;
+    case ' ':
+      if (wasSpace)
+      {
+        flushText();
+        painter->insertSpace();
+      }
+      else
+      {
+        wasSpace = true;
+        curText.push_back(' ');
+      }
+      break;
+    default:
+      wasSpace = false;
+      if (utf8Char[0] >= 0 && utf8Char[0] <= 0x1f)
+        break;
+      curText.append(utf8Char);
+      break;
+    }
+  }
+
+  flushText();
+}
+
+}
 
 class UtilsTest : public CPPUNIT_NS::TestFixture
 {
@@ -36,12 +103,14 @@ private:
   CPPUNIT_TEST(testFloat16);
   CPPUNIT_TEST(testReadFraction);
   CPPUNIT_TEST(testGetRemainingLength);
+  CPPUNIT_TEST(testInsertText);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testFloat16();
   void testReadFraction();
   void testGetRemainingLength();
+  void testInsertText();
 };
 
 void UtilsTest::setUp()
@@ -107,6 +176,60 @@ void UtilsTest::testGetRemainingLength()
   CPPUNIT_ASSERT_EQUAL(0ul, getRemainingLength(stream));
 }
 
+void UtilsTest::testInsertText()
+{
+  {
+    QXPTracingPainter painter;
+    libqxp::insertText(&painter, "a  b\tc\r\nd");
+    CPPUNIT_ASSERT_EQUAL(string("insertText(a )\ninsertSpace()\ninsertText(b)\ninsertTab()\ninsertText(c)\ninsertLineBreak()\ninsertText(d)\n"), painter.trace);
+  }
+
+  const char *const texts[] =
+  {
+    "",
+    "a",
+    " ",
+    "  ",
+    "   ",
+    "a b",
+    "a  b",
+    "a   b",
+    "  a",
+    "a   ",
+    // runs of spaces across the 8 byte words
+    "abcdefg b",
+    "abcdefg  b",
+    "abcdef   b",
+    "abcdefghijklmno   pqrstuvw  xyz",
+    // runs of spaces right after control chars
+    "a\t b",
+    "a\t  b",
+    "a\n   b",
+    "abcdefgh\t  ijklmnop\n   q",
+    " \t \n  ",
+    // carriage returns and other control chars
+    "a\rb",
+    "a \r b",
+    "a\r\nb",
+    "a\x01b\x1f",
+    "abcdefghijk\x1flmnop\x10qrstuvwxyz",
+    "\x1f\x1e\x1d\x1c\x1b\x1a\x19\x18\x17",
+    // characters encoded as more than one byte are never control chars
+    "\xc5\xbelu\xc5\xa5ou\xc4\x8dk\xc3\xbd k\xc5\xaf\xc5\x88  \xc3\xbap\xc4\x9bl",
+    "\xe2\x80\x94\xe2\x80\x94\xe2\x80\x94  \xe2\x80\x94\xe2\x80\x94\xe2\x80\x94\t\xe2\x80\x94",
+    "\xc2\xa0\xc2\xa0\xc2\xa0\xc2\xa0 \xc2\xa0",
+  };
+
+  for (const auto text : texts)
+  {
+    QXPTracingPainter expected;
+    insertTextByCharacter(&expected, text);
+    QXPTracingPainter painter;
+    libqxp::insertText(&painter, text);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(text, expected.trace, painter.trace);
+  }
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(UtilsTest);
 
 }